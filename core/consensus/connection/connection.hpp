@@ -28,7 +28,12 @@ limitations under the License.
 namespace connection {
 
     using Api::ConsensusEvent;
+    using Api::StatusResponse;
+    using Api::ConsensusVote;
+    using Api::CommitCertificate;
+    using Api::CommitRequest;
     using Api::Transaction;
+    using Api::TransactionBatch;
     using Api::Query;
     using Api::TransactionResponse;
 
@@ -53,6 +58,13 @@ namespace connection {
 
                 bool sendAll(const ConsensusEvent &msg);
 
+                // Sends to every peer at once and returns as soon as quorum
+                // valid confirmations are in; the calls still pending carry
+                // on in the background. Returns the number of valid
+                // confirmations; with the stream transport, the number of
+                // peers it was queued for.
+                std::size_t sendAll(const ConsensusEvent &msg, std::size_t quorum);
+
                 bool receive(const std::function<void(
                     const std::string &,
                     ConsensusEvent &)
@@ -60,6 +72,42 @@ namespace connection {
 
             };
 
+            // Vote-only protocol, see sumeragi.
+            namespace Vote {
+
+                bool send(
+                        const std::string &ip,
+                        const ConsensusVote &vote
+                );
+
+                bool receive(const std::function<void(
+                    const std::string &,
+                    ConsensusVote &)
+                > &callback);
+
+            };
+
+            namespace Commit {
+
+                // To every peer but this one; returns how many took it.
+                std::size_t sendAll(const CommitCertificate &certificate);
+
+                // Asks ip for the committed block of order, within
+                // grpc_send_deadline_millis. False if it could not answer
+                // or has not committed it; the signatures are unchecked.
+                bool fetch(
+                        const std::string &ip,
+                        std::uint64_t order,
+                        ConsensusEvent &event
+                );
+
+                bool receive(const std::function<void(
+                    const std::string &,
+                    CommitCertificate &)
+                > &callback);
+
+            };
+
             namespace Torii {
 
                 bool receive(const std::function<void(
@@ -67,6 +115,15 @@ namespace connection {
                     Transaction&)
                 > &callback);
 
+                // Runs before the receivers. A check that returns false
+                // turns the transaction away: the reply says "REJECTED",
+                // with whatever message and retry hint the check set.
+                bool admit(const std::function<bool(
+                    const std::string &,
+                    const Transaction&,
+                    StatusResponse&)
+                > &check);
+
             };
             // This only reply pong.
             namespace Kagami{}
@@ -81,6 +138,15 @@ namespace connection {
                         const Transaction &transaction
                 );
 
+                // One call for the whole batch, bounded by
+                // grpc_send_deadline_millis. False when the peer could not
+                // be reached in time; whatever it turned away is only
+                // logged.
+                bool forward(
+                        const std::string &ip,
+                        const TransactionBatch &batch
+                );
+
                 bool ping(
                         const std::string &ip
                 );
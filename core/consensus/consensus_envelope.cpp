@@ -0,0 +1,58 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <crypto/hash.hpp>
+
+#include "consensus_envelope.hpp"
+
+namespace sumeragi {
+
+std::string hashTransaction(const Transaction &tx) {
+  Transaction body(tx);
+  body.clear_txsignatures();
+  body.clear_hash();
+  return hash::sha3_256_hex(body.SerializeAsString());
+}
+
+std::string hashBlock(const ConsensusEvent &event,
+                      const std::vector<std::string> &transactionDigests) {
+  std::string canonical = std::to_string(event.order()) + ":" +
+                          std::to_string(event.block().timestamp()) + ":";
+  for (auto &&digest : transactionDigests) {
+    canonical += digest;
+  }
+  return hash::sha3_256_hex(canonical);
+}
+
+ConsensusEnvelope makeEnvelope(ConsensusEvent event) {
+  std::vector<std::string> transactionDigests;
+  transactionDigests.reserve(event.block().transactions_size());
+  for (auto &&tx : event.block().transactions()) {
+    transactionDigests.push_back(hashTransaction(tx));
+  }
+  return makeEnvelope(std::move(event), std::move(transactionDigests));
+}
+
+ConsensusEnvelope makeEnvelope(ConsensusEvent event,
+                               std::vector<std::string> transactionDigests) {
+  ConsensusEnvelope envelope;
+  envelope.digest = hashBlock(event, transactionDigests);
+  envelope.event.Swap(&event);
+  envelope.transactionDigests = std::move(transactionDigests);
+  return envelope;
+}
+
+};  // namespace sumeragi
@@ -0,0 +1,64 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_CONSENSUS_CONSENSUSENVELOPE_HPP_
+#define CORE_CONSENSUS_CONSENSUSENVELOPE_HPP_
+
+#include <string>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+namespace sumeragi {
+
+using Api::ConsensusEvent;
+using Api::Transaction;
+
+/**
+ * A consensus event together with its digests, worked out once when the
+ * event enters this peer and carried through signing, validation, dedup and
+ * the Merkle append.
+ */
+struct ConsensusEnvelope {
+  ConsensusEvent event;
+  // what every peer signs and what the block is stored under
+  std::string digest;
+  // one per transaction, in block order
+  std::vector<std::string> transactionDigests;
+  // the signatures of event.signatureset() already found valid over
+  // digest, so none is verified twice
+  Api::SignatureSet verified;
+};
+
+// Over the transaction without its signatures and hash field, so signing it
+// again or adding a signature does not make it a different transaction.
+std::string hashTransaction(const Transaction &tx);
+
+// Covers the order, the timestamp and every transaction digest, so the
+// block body never has to be serialized again to be signed.
+std::string hashBlock(const ConsensusEvent &event,
+                      const std::vector<std::string> &transactionDigests);
+
+// Hashes every transaction of the event once.
+ConsensusEnvelope makeEnvelope(ConsensusEvent event);
+
+// For blocks cut locally, whose transactions were hashed at Torii ingress.
+ConsensusEnvelope makeEnvelope(ConsensusEvent event,
+                               std::vector<std::string> transactionDigests);
+
+};  // namespace sumeragi
+
+#endif  // CORE_CONSENSUS_CONSENSUSENVELOPE_HPP_
@@ -0,0 +1,184 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mempool.hpp"
+
+#include <algorithm>
+
+namespace mempool {
+
+const char *describe(Admission status) {
+  switch (status) {
+    case Admission::ACCEPTED:
+      return "accepted";
+    case Admission::DUPLICATE:
+      return "duplicate transaction";
+    case Admission::FULL:
+      return "mempool is full";
+    case Admission::SENDER_FULL:
+      return "too many pending transactions from this sender";
+  }
+  return "rejected";
+}
+
+Mempool::Mempool(const Options &options) : options_(options) {}
+
+Result Mempool::add(const Transaction &transaction,
+                    const std::string &digest) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (digests_.count(digest) != 0) {
+    duplicates_++;
+    return {Admission::DUPLICATE, std::chrono::milliseconds(0)};
+  }
+
+  const auto &sender = transaction.senderpubkey();
+  auto found = senders_.find(sender);
+  const std::size_t queued =
+      found == senders_.end() ? 0 : found->second.queue.size();
+  if (queued >= options_.senderCapacity) {
+    rejected_++;
+    return {Admission::SENDER_FULL, retryHint()};
+  }
+  if (size_ >= options_.capacity && !evictFor(sender)) {
+    rejected_++;
+    return {Admission::FULL, retryHint()};
+  }
+
+  push(sender, Entry{transaction, digest});
+  accepted_++;
+  return {Admission::ACCEPTED, std::chrono::milliseconds(0)};
+}
+
+std::vector<Entry> Mempool::takeBatch(std::size_t max) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Entry> batch;
+  while (batch.size() < max && !ready_.empty()) {
+    // one from the sender at the head, which then goes to the back
+    auto sender = senders_.find(ready_.front());
+    const bool drained = sender->second.queue.size() == 1;
+    batch.push_back(popFront(sender));
+    if (!drained) {
+      ready_.splice(ready_.end(), ready_, ready_.begin());
+    }
+  }
+
+  auto now = Clock::now();
+  if (!batch.empty()) {
+    if (taken_ > 0) {
+      takeInterval_ = now - lastTaken_;
+    }
+    lastTaken_ = now;
+    taken_ += batch.size();
+  }
+  return batch;
+}
+
+std::size_t Mempool::expire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto deadline = Clock::now() - options_.ttl;
+  std::size_t dropped = 0;
+  for (auto sender = senders_.begin(); sender != senders_.end();) {
+    auto &queue = sender->second.queue;
+    while (queue.size() > 1 && queue.front().arrived < deadline) {
+      popFront(sender);
+      dropped++;
+    }
+    if (queue.front().arrived < deadline) {
+      // the last one takes the sender with it
+      auto next = std::next(sender);
+      popFront(sender);
+      dropped++;
+      sender = next;
+    } else {
+      ++sender;
+    }
+  }
+  expired_ += dropped;
+  return dropped;
+}
+
+std::size_t Mempool::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+Stats Mempool::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t largest = 0;
+  for (auto &&sender : senders_) {
+    largest = std::max(largest, sender.second.queue.size());
+  }
+  return Stats{size_,      senders_.size(), largest,  accepted_, duplicates_,
+               rejected_,  evicted_,        expired_, taken_};
+}
+
+void Mempool::push(const std::string &sender, Entry &&entry) {
+  auto &queue = senders_[sender];
+  if (queue.queue.empty()) {
+    queue.ready = ready_.insert(ready_.end(), sender);
+  }
+  digests_.insert(entry.digest);
+  queue.queue.push_back(Queued{std::move(entry), Clock::now()});
+  size_++;
+}
+
+Entry Mempool::popFront(
+    std::unordered_map<std::string, SenderQueue>::iterator sender) {
+  auto &queue = sender->second.queue;
+  auto entry = std::move(queue.front().entry);
+  digests_.erase(entry.digest);
+  queue.pop_front();
+  size_--;
+  if (queue.empty()) {
+    ready_.erase(sender->second.ready);
+    senders_.erase(sender);
+  }
+  return entry;
+}
+
+// Makes room by dropping the newest transaction of the longest queue, if
+// that queue is longer than the one of sender.
+bool Mempool::evictFor(const std::string &sender) {
+  auto found = senders_.find(sender);
+  const std::size_t own =
+      found == senders_.end() ? 0 : found->second.queue.size();
+  auto longest = senders_.end();
+  for (auto it = senders_.begin(); it != senders_.end(); ++it) {
+    if (longest == senders_.end() ||
+        it->second.queue.size() > longest->second.queue.size()) {
+      longest = it;
+    }
+  }
+  if (longest == senders_.end() || longest->second.queue.size() <= own + 1) {
+    return false;
+  }
+
+  auto &queue = longest->second.queue;
+  digests_.erase(queue.back().entry.digest);
+  queue.pop_back();
+  size_--;
+  evicted_++;
+  return true;
+}
+
+// The next batch makes room, so the hint is the time between the last two.
+std::chrono::milliseconds Mempool::retryHint() const {
+  return std::max(options_.retryAfter,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(
+                      takeInterval_));
+}
+
+}  // namespace mempool
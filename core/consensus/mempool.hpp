@@ -0,0 +1,150 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_CONSENSUS_MEMPOOL_HPP_
+#define CORE_CONSENSUS_MEMPOOL_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+namespace mempool {
+
+using Api::Transaction;
+
+enum class Admission {
+  ACCEPTED,
+  DUPLICATE,   // already waiting here, or already committed
+  FULL,        // no room left and nothing fairer to evict
+  SENDER_FULL, // this sender has too many transactions waiting
+};
+
+// Short reason for a rejection, as told to the client.
+const char *describe(Admission status);
+
+struct Result {
+  Admission status;
+  // for FULL and SENDER_FULL: when a retry is likely to get in
+  std::chrono::milliseconds retryAfter;
+};
+
+struct Options {
+  std::size_t capacity;
+  std::size_t senderCapacity;
+  std::chrono::milliseconds ttl;
+  // the shortest retry hint handed out
+  std::chrono::milliseconds retryAfter;
+};
+
+struct Entry {
+  Transaction transaction;
+  std::string digest;
+};
+
+struct Stats {
+  std::size_t size;
+  std::size_t senders;
+  std::size_t largestSenderQueue;
+  std::uint64_t accepted;
+  std::uint64_t duplicates;
+  std::uint64_t rejected;
+  std::uint64_t evicted;
+  std::uint64_t expired;
+  std::uint64_t taken;
+};
+
+/**
+ * Transactions admitted by Torii, waiting to be cut into blocks.
+ *
+ * Every sender has its own FIFO queue and batches are taken round-robin
+ * across senders, so one busy sender cannot starve the others. Digests are
+ * indexed, so a transaction is only ever queued once. When the pool is
+ * full, a newcomer displaces the newest transaction of the sender with the
+ * longest queue, provided its own sender's queue is shorter; otherwise it
+ * is turned away with a retry hint worked out from how fast batches have
+ * been leaving. Transactions older than the TTL are dropped.
+ */
+class Mempool {
+ public:
+  explicit Mempool(const Options &options);
+
+  Mempool(const Mempool &) = delete;
+  Mempool &operator=(const Mempool &) = delete;
+
+  // The sender is the transaction's senderPubkey.
+  Result add(const Transaction &transaction, const std::string &digest);
+
+  // Up to max transactions, oldest first for each sender.
+  std::vector<Entry> takeBatch(std::size_t max);
+
+  // Drops what has outlived the TTL and returns how many.
+  std::size_t expire();
+
+  std::size_t size();
+  Stats stats();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Queued {
+    Entry entry;
+    Clock::time_point arrived;
+  };
+
+  struct SenderQueue {
+    std::deque<Queued> queue;
+    // position in ready_, valid while queue is not empty
+    std::list<std::string>::iterator ready;
+  };
+
+  void push(const std::string &sender, Entry &&entry);
+  // Erases the sender once its queue is empty.
+  Entry popFront(std::unordered_map<std::string, SenderQueue>::iterator sender);
+  bool evictFor(const std::string &sender);
+  std::chrono::milliseconds retryHint() const;
+
+  const Options options_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, SenderQueue> senders_;
+  // senders with something queued, in round-robin order
+  std::list<std::string> ready_;
+  std::unordered_set<std::string> digests_;
+  std::size_t size_ = 0;
+
+  // how fast batches have been leaving, for the retry hint
+  Clock::time_point lastTaken_;
+  std::chrono::nanoseconds takeInterval_{0};
+
+  std::uint64_t accepted_ = 0;
+  std::uint64_t duplicates_ = 0;
+  std::uint64_t rejected_ = 0;
+  std::uint64_t evicted_ = 0;
+  std::uint64_t expired_ = 0;
+  std::uint64_t taken_ = 0;
+};
+
+}  // namespace mempool
+
+#endif  // CORE_CONSENSUS_MEMPOOL_HPP_
@@ -14,28 +14,45 @@ limitations under the License.
 
 #include "sumeragi.hpp"
 #include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <thread_pool.hpp>
 
+#include <crypto/base64.hpp>
 #include <crypto/hash.hpp>
 #include <crypto/signature.hpp>
 #include <repository/consensus/merkle_transaction_repository.hpp>
+#include <util/datetime.hpp>
+#include <util/dedup_cache.hpp>
 #include <util/logger.hpp>
+#include <util/timer_wheel.hpp>
 
 #include <consensus/connection/connection.hpp>
+#include <consensus/consensus_envelope.hpp>
 #include <infra/config/peer_service_with_json.hpp>
 #include <repository/transaction_repository.hpp>
+#include <repository/world_state_repository.hpp>
 #include <service/peer_service.hpp>
 #include <service/peer_service.hpp>
+#include <validation/admission.hpp>
+#include <validation/prevalidation.hpp>
+#include <validation/signature_set.hpp>
+#include <validation/signature_verifier.hpp>
 #include <validation/transaction_validator.hpp>
 
 #include <infra/config/iroha_config_with_json.hpp>
-#include <service/executor.hpp>
+#include <service/block_executor.hpp>
+#include <service/hijiri.hpp>
 
 /**
 * |ーーー|　|ーーー|　|ーーー|　|ーーー|
@@ -55,9 +72,10 @@ namespace sumeragi {
 
 using Api::ConsensusEvent;
 using Api::Signature;
+using Api::SignatureSet;
+using Api::StatusResponse;
 using Api::Transaction;
-
-std::map<std::string, std::string> txCache;
+using Api::TransactionBatch;
 
 static ThreadPool pool(ThreadPoolOptions{
     .threads_count =
@@ -66,22 +84,752 @@ static ThreadPool pool(ThreadPoolOptions{
         config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
 });
 
+/**
+ * What a round needs to know about the peers, worked out once from one
+ * PeerSet and never changed afterwards. A round takes a snapshot when it
+ * starts and works off it, so a peer set change cannot show up halfway
+ * through, and pool threads never read a Context that is being written.
+ */
+struct Context {
+  bool isSumeragi;         // am I the leader or am I not?
+  std::uint64_t maxFaulty; // f
+  std::uint64_t proxyTailNdx;
+  std::uint64_t numValidatingPeers;
+  std::string myPublicKey;
+  std::uint32_t myIndex; // signer index; publicKeys.size() if not a validator
+  std::uint32_t leaderIndex; // signer index of validatingPeers[0]
+  peer::Nodes validatingPeers;
+  std::vector<std::string> publicKeys; // of validatingPeers, by signer index
+  std::shared_ptr<const peer::PeerSet> peers;
+
+  explicit Context(std::shared_ptr<const peer::PeerSet> latest)
+      : peers(std::move(latest)) {
+    logger::debug("sumeragi") << "Context update! peer set version "
+                              << peers->version;
+    validatingPeers = peers->nodes;
+
+    numValidatingPeers = validatingPeers.size();
+    // maxFaulty = Default to approx. 1/3 of the network.
+    maxFaulty = peers->maxFaulty;
+    proxyTailNdx = this->maxFaulty * 2 + 1;
+
+    if (validatingPeers.empty()) {
+      logger::error("sumeragi") << "could not find any validating peers.";
+      exit(EXIT_FAILURE);
+    }
+
+    if (proxyTailNdx >= validatingPeers.size()) {
+      proxyTailNdx = validatingPeers.size() - 1;
+    }
+
+    myPublicKey = ::peer::myself::getPublicKey();
+    publicKeys = peers->signers;
+    myIndex = signerIndex(myPublicKey);
+    leaderIndex = signerIndex(validatingPeers.at(0)->publicKey);
+
+    isSumeragi = validatingPeers.at(0)->publicKey == myPublicKey;
+  }
+
+  bool isSigner() const { return myIndex < publicKeys.size(); }
+
+private:
+  std::uint32_t signerIndex(const std::string &publicKey) const {
+    return std::lower_bound(publicKeys.begin(), publicKeys.end(), publicKey) -
+           publicKeys.begin();
+  }
+};
+
+using ContextPtr = std::shared_ptr<const Context>;
+
 namespace detail {
 
-std::string hash(const Transaction &tx) {
-  return hash::sha3_256_hex(tx.SerializeAsString());
+ContextPtr latestContext;
+
+// Rounds that timed out in a row; widens the panic broadcast.
+std::atomic<std::int32_t> panicCount(0);
+
+// Rebuilt only when the peer service has published a new PeerSet.
+ContextPtr snapshot() {
+  auto peers = ::peer::service::getPeerSet();
+  auto current = std::atomic_load(&latestContext);
+  if (current != nullptr && current->peers == peers) {
+    return current;
+  }
+  ContextPtr next = std::make_shared<const Context>(std::move(peers));
+  std::atomic_store(&latestContext, next);
+  return next;
+}
+
+} // namespace detail
+
+namespace detail {
+
+// Transactions committed in recent rounds, so a replayed one is not
+// executed twice. Older ones are looked up on the ledger.
+dedup::DedupCache &txCache() {
+  static dedup::DedupCache cache(
+      config::IrohaConfigManager::getInstance().getDedupCacheCapacity(1 << 20),
+      config::IrohaConfigManager::getInstance().getDedupCacheShards(16),
+      config::IrohaConfigManager::getInstance().getDedupCacheBloomCounters(1 << 23));
+  return cache;
+}
+
+// The cache only answers for the last dedup_retain_rounds rounds.
+bool alreadyCommitted(const std::string &txHash) {
+  return txCache().contains(dedup::fromHex(txHash)) ||
+         repository::transaction::exists(txHash);
+}
+
+std::uint64_t dedupRetainRounds() {
+  static const std::uint64_t rounds =
+      config::IrohaConfigManager::getInstance().getDedupRetainRounds(1024);
+  return rounds;
+}
+
+// Transactions admitted by Torii, hashed on the way in.
+mempool::Mempool &transactionPool() {
+  static mempool::Mempool instance(mempool::Options{
+      config::IrohaConfigManager::getInstance().getMempoolCapacity(100000),
+      config::IrohaConfigManager::getInstance().getMempoolSenderCapacity(1024),
+      std::chrono::milliseconds(
+          config::IrohaConfigManager::getInstance().getMempoolTtlMillis(60000)),
+      std::chrono::milliseconds(
+          config::IrohaConfigManager::getInstance().getMempoolRetryAfterMillis(
+              100)),
+  });
+  return instance;
+}
+
+// A block opens when a transaction lands in an empty mempool and is cut
+// block_max_wait_millis later, or as soon as a full block is waiting.
+struct PendingBlock {
+  std::mutex mutex;
+  std::condition_variable arrived;
+  bool open = false;
+  std::chrono::steady_clock::time_point openedAt;
 };
 
-void addSignature(ConsensusEvent &event, const std::string &publicKey,
-                  const std::string &signature) {
-  Signature sig;
-  sig.set_signature(signature);
-  sig.set_publickey(publicKey);
-  event.add_eventsignatures()->CopyFrom(sig);
+PendingBlock pendingBlock;
+
+std::size_t blockMaxTransactions() {
+  static const std::size_t maxTransactions = std::max<std::size_t>(
+      1, config::IrohaConfigManager::getInstance().getBlockMaxTransactions(128));
+  return maxTransactions;
+}
+
+std::chrono::milliseconds blockMaxWait() {
+  static const std::chrono::milliseconds maxWait(
+      config::IrohaConfigManager::getInstance().getBlockMaxWaitMillis(50));
+  return maxWait;
+}
+
+ConsensusEvent buildBlockEvent(std::vector<Transaction> &&transactions) {
+  ConsensusEvent event;
+  event.set_status("uncommit");
+  auto block = event.mutable_block();
+  for (auto &&tx : transactions) {
+    block->add_transactions()->Swap(&tx);
+  }
+  block->set_timestamp(datetime::unixtime());
+  return event;
+}
+
+void dispatchBlock(std::vector<Transaction> &&transactions,
+                   std::vector<std::string> &&digests) {
+  auto event = buildBlockEvent(std::move(transactions));
+  event.set_order(getNextOrder());
+  logger::info("sumeragi") << "cut block " << event.order() << " of "
+                           << event.block().transactions_size()
+                           << " transactions";
+  auto envelope = makeEnvelope(std::move(event), std::move(digests));
+  std::function<void()> &&task = std::bind(processEnvelope, envelope);
+  pool.process(std::move(task));
+}
+
+// Lets the loop know there is something to cut.
+void openPendingBlock() {
+  std::lock_guard<std::mutex> lock(pendingBlock.mutex);
+  if (!pendingBlock.open) {
+    pendingBlock.open = true;
+    pendingBlock.openedAt = std::chrono::steady_clock::now();
+    pendingBlock.arrived.notify_one();
+  }
+}
+
+/**
+ * Hands a batch over to the leader. If the leader cannot be reached, the
+ * transactions go back into the mempool and are tried again with the next
+ * block, until the TTL gives up on them.
+ */
+void forwardBatch(const std::string &leader,
+                  const std::vector<mempool::Entry> &batch) {
+  TransactionBatch transactions;
+  for (auto &&entry : batch) {
+    transactions.add_transactions()->CopyFrom(entry.transaction);
+  }
+  if (connection::iroha::PeerService::Sumeragi::forward(leader,
+                                                        transactions)) {
+    return;
+  }
+
+  auto &mempool = transactionPool();
+  std::size_t requeued = 0;
+  for (auto &&entry : batch) {
+    if (mempool.add(entry.transaction, entry.digest).status ==
+        mempool::Admission::ACCEPTED) {
+      requeued++;
+    }
+  }
+  logger::warning("sumeragi") << "could not forward " << batch.size()
+                              << " transactions to " << leader << ", "
+                              << requeued << " requeued";
+  if (requeued > 0) {
+    openPendingBlock();
+  }
+}
+
+bool pipelineIsFull();
+
+/**
+ * Takes the next block off the mempool. The leader puts it through
+ * consensus; any other peer hands its transactions over to the leader.
+ */
+void cutBlock() {
+  auto &mempool = transactionPool();
+  auto expired = mempool.expire();
+  if (expired > 0) {
+    logger::warning("sumeragi") << expired
+                                << " transactions expired in the mempool";
+  }
+  if (snapshot()->isSumeragi && pipelineIsFull()) {
+    // cut again once a round commits; Torii keeps filling the mempool
+    std::lock_guard<std::mutex> lock(pendingBlock.mutex);
+    pendingBlock.open = mempool.size() > 0;
+    pendingBlock.openedAt = std::chrono::steady_clock::now();
+    return;
+  }
+  auto batch = mempool.takeBatch(blockMaxTransactions());
+  {
+    std::lock_guard<std::mutex> lock(pendingBlock.mutex);
+    pendingBlock.open = mempool.size() > 0;
+    pendingBlock.openedAt = std::chrono::steady_clock::now();
+  }
+  if (batch.empty()) {
+    return;
+  }
+
+  auto context = snapshot();
+  if (!context->isSumeragi) {
+    std::function<void()> &&task =
+        std::bind(forwardBatch, context->validatingPeers.at(0)->ip,
+                  std::move(batch));
+    pool.process(std::move(task));
+    return;
+  }
+
+  std::vector<Transaction> transactions;
+  std::vector<std::string> digests;
+  for (auto &&entry : batch) {
+    transactions.push_back(std::move(entry.transaction));
+    digests.push_back(std::move(entry.digest));
+  }
+  dispatchBlock(std::move(transactions), std::move(digests));
+}
+
+// Awk timers still waiting on a round, by digest; cancelled once it commits.
+struct AwkTimers {
+  std::mutex mutex;
+  std::map<std::string, timer::TimerId> byDigest;
+};
+
+AwkTimers awkTimers;
+
+// A round that made progress starts its wait over.
+void watchRound(const std::string &digest, timer::TimerId id) {
+  std::lock_guard<std::mutex> lock(awkTimers.mutex);
+  auto &watched = awkTimers.byDigest[digest];
+  if (watched != 0) {
+    timer::cancel(watched);
+  }
+  watched = id;
+}
+
+void unwatchRound(const std::string &digest) {
+  std::lock_guard<std::mutex> lock(awkTimers.mutex);
+  auto found = awkTimers.byDigest.find(digest);
+  if (found != awkTimers.byDigest.end()) {
+    timer::cancel(found->second);
+    awkTimers.byDigest.erase(found);
+  }
+}
+
+struct CommitQueue {
+  std::mutex mutex;
+  std::uint64_t lastCommitted = 0;
+  // commit notices that arrived ahead of their turn
+  std::map<std::uint64_t, ConsensusEnvelope> reorderBuffer;
+  // rounds too far ahead of the last commit to be worked on yet
+  std::map<std::uint64_t, ConsensusEnvelope> deferred;
+  // a round is missing before the head of reorderBuffer and is due to be
+  // fetched from the other peers
+  bool catchUpScheduled = false;
+  // the head of reorderBuffer failed to write and is due to be retried
+  bool retryScheduled = false;
+};
+
+CommitQueue commitQueue;
+
+// The last order this peer handed out as leader.
+std::atomic<std::uint64_t> lastAssigned(0);
+
+std::uint64_t pipelineWindow() {
+  static const std::uint64_t window = std::max<std::size_t>(
+      1, config::IrohaConfigManager::getInstance().getPipelineWindow(8));
+  return window;
+}
+
+// The leader hands out no order beyond the window, so a stalled commit
+// holds back new blocks rather than filling the reorder buffer.
+bool pipelineIsFull() {
+  std::lock_guard<std::mutex> lock(commitQueue.mutex);
+  return lastAssigned.load() >= commitQueue.lastCommitted + pipelineWindow();
+}
+
+std::chrono::milliseconds orderGapTimeout() {
+  static const std::chrono::milliseconds timeout(
+      config::IrohaConfigManager::getInstance().getOrderGapTimeoutMillis(
+          10000));
+  return timeout;
+}
+
+// How far past the last commit a round or commit notice is still kept.
+std::uint64_t commitBufferCapacity() {
+  static const std::uint64_t capacity = std::max<std::size_t>(
+      1, config::IrohaConfigManager::getInstance().getCommitBufferCapacity(
+             1024));
+  return capacity;
+}
+
+// Returns false if the round is stale or was parked until the window moves.
+bool admitRound(const ConsensusEnvelope &envelope) {
+  const auto &event = envelope.event;
+  std::lock_guard<std::mutex> lock(commitQueue.mutex);
+  if (event.order() <= commitQueue.lastCommitted) {
+    logger::info("sumeragi") << "round " << event.order() << " is stale";
+    return false;
+  }
+  if (event.order() > commitQueue.lastCommitted + commitBufferCapacity()) {
+    logger::warning("sumeragi") << "round " << event.order()
+                                << " is too far ahead, dropped";
+    return false;
+  }
+  if (event.order() > commitQueue.lastCommitted + pipelineWindow()) {
+    logger::info("sumeragi") << "round " << event.order() << " is deferred";
+    commitQueue.deferred[event.order()] = envelope;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Vote-only protocol ("consensus_protocol": "vote"). The leader sends the
+ * block body to every peer once; from then on peers only exchange
+ * ConsensusVotes over its digest. The proxy tail gathers 2f+1 of them into
+ * a CommitCertificate and announces it. Votes and certificates may overtake
+ * the body they refer to, so a round lives here, by digest, until it
+ * commits.
+ */
+bool voteProtocol() {
+  static const bool vote =
+      config::IrohaConfigManager::getInstance().getConsensusProtocol("full") ==
+      "vote";
+  return vote;
+}
+
+struct VoteRound {
+  std::uint64_t order = 0;
+  bool hasBody = false;
+  ConsensusEnvelope envelope;
+  // verified votes over the digest
+  SignatureSet signatures;
+  bool certified = false; // a valid certificate arrived
+  bool committed = false;
+};
+
+struct VoteRounds {
+  std::mutex mutex;
+  std::unordered_map<std::string, VoteRound> byDigest;
+  // what this peer voted for, by order; it never votes twice for an order
+  std::map<std::uint64_t, std::string> ownVotes;
+  // on the proxy tail, what each signer voted for, by order
+  std::map<std::uint64_t, std::unordered_map<std::uint32_t, std::string>>
+      votes;
+};
+
+VoteRounds voteRounds;
+
+/**
+ * Full protocol: copies of one event keep arriving, each with a different
+ * subset of signatures. They are merged here into one state per digest,
+ * and a copy only causes work (count, maybe sign and re-broadcast) when it
+ * adds a signer. One pool thread handles a round at a time; copies that
+ * arrive meanwhile are merged and picked up when it is done.
+ */
+struct SigningRound {
+  ConsensusEnvelope state;
+  bool busy = false;
+  bool grown = false; // merged while busy
+};
+
+struct SigningRounds {
+  std::mutex mutex;
+  std::unordered_map<std::string, SigningRound> byDigest;
+};
+
+SigningRounds signingRounds;
+
+// Merges the copy into its round. Returns true if the caller should
+// process the round, in which case envelope now holds the merged state.
+bool joinRound(ConsensusEnvelope &envelope) {
+  std::lock_guard<std::mutex> lock(signingRounds.mutex);
+  auto found = signingRounds.byDigest.find(envelope.digest);
+  if (found == signingRounds.byDigest.end()) {
+    auto &round = signingRounds.byDigest[envelope.digest];
+    round.state = envelope;
+    round.busy = true;
+    return true;
+  }
+
+  auto &round = found->second;
+  if (signature_set::merge(*round.state.event.mutable_signatureset(),
+                           envelope.event.signatureset()) == 0) {
+    logger::debug("sumeragi") << "copy of round " << envelope.event.order()
+                              << " brought no new signer";
+    return false;
+  }
+  if (round.busy) {
+    round.grown = true;
+    return false;
+  }
+  round.busy = true;
+  envelope = round.state;
+  return true;
+}
+
+// Keeps what processing learned (our signature, verified signers). Returns
+// true if the round grew meanwhile and has to be processed again.
+bool leaveRound(ConsensusEnvelope &envelope) {
+  std::lock_guard<std::mutex> lock(signingRounds.mutex);
+  auto found = signingRounds.byDigest.find(envelope.digest);
+  if (found == signingRounds.byDigest.end()) {
+    return false; // committed meanwhile
+  }
+  auto &round = found->second;
+  signature_set::merge(*round.state.event.mutable_signatureset(),
+                       envelope.event.signatureset());
+  signature_set::merge(round.state.verified, envelope.verified);
+  if (!round.grown) {
+    round.busy = false;
+    return false;
+  }
+  round.grown = false;
+  envelope = round.state;
+  return true;
+}
+
+void forgetSigningRounds(std::uint64_t committedOrder) {
+  std::lock_guard<std::mutex> lock(signingRounds.mutex);
+  for (auto it = signingRounds.byDigest.begin();
+       it != signingRounds.byDigest.end();) {
+    if (it->second.state.event.order() <= committedOrder) {
+      it = signingRounds.byDigest.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// Called from applyCommit; also drops votes that arrived too late.
+void forgetVoteRounds(std::uint64_t committedOrder) {
+  std::lock_guard<std::mutex> lock(voteRounds.mutex);
+  for (auto it = voteRounds.byDigest.begin();
+       it != voteRounds.byDigest.end();) {
+    if (it->second.order <= committedOrder) {
+      it = voteRounds.byDigest.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  voteRounds.ownVotes.erase(voteRounds.ownVotes.begin(),
+                            voteRounds.ownVotes.upper_bound(committedOrder));
+  voteRounds.votes.erase(voteRounds.votes.begin(),
+                         voteRounds.votes.upper_bound(committedOrder));
+}
+
+// Writes the block. Nothing is marked as committed and no round is
+// forgotten unless the write goes through, so a block that failed can be
+// applied again.
+bool applyCommit(const ConsensusEnvelope &envelope) {
+  const auto &transactions = envelope.event.block().transactions();
+  const auto order = envelope.event.order();
+  // The Merkle leaf, the transactions and their effects reach the ledger
+  // in one write.
+  repository::world_state_repository::BlockOverlay overlay;
+  std::vector<int> fresh;
+  {
+    repository::world_state_repository::ScopeGuard scope(&overlay);
+    merkle_transaction_repository::commit(envelope.event, envelope.digest,
+                                          envelope.transactionDigests,
+                                          envelope.verified);
+    std::unordered_set<std::string> inBlock;
+    std::vector<const Transaction *> executed;
+    for (int i = 0; i < transactions.size(); i++) {
+      const auto &txHash = envelope.transactionDigests[i];
+      if (inBlock.insert(txHash).second && !alreadyCommitted(txHash)) {
+        repository::transaction::add(txHash, transactions.Get(i));
+        fresh.push_back(i);
+        executed.push_back(&transactions.Get(i));
+      }
+    }
+    block_executor::execute(executed);
+  }
+  if (!overlay.commit()) {
+    logger::error("sumeragi") << "could not write block " << order
+                              << ", it will be retried";
+    return false;
+  }
+
+  for (auto i : fresh) {
+    txCache().insert(dedup::fromHex(envelope.transactionDigests[i]), order);
+    admission::committed(transactions.Get(i));
+  }
+  if (order > dedupRetainRounds()) {
+    txCache().evictBefore(order - dedupRetainRounds());
+  }
+  unwatchRound(envelope.digest);
+  panicCount = 0;
+  if (voteProtocol()) {
+    forgetVoteRounds(order);
+  } else {
+    forgetSigningRounds(order);
+  }
+  return true;
+}
+
+void commitInOrder(const ConsensusEnvelope &envelope);
+
+// A block that could not be written stays at the head of the reorder
+// buffer and is tried again every order_gap_timeout_millis; nothing after
+// it is committed meanwhile. Called with commitQueue.mutex held.
+void retryCommit(const ConsensusEnvelope &envelope) {
+  if (commitQueue.retryScheduled) {
+    return;
+  }
+  commitQueue.retryScheduled = true;
+  setAwkTimer(orderGapTimeout().count(), [envelope]() {
+    {
+      std::lock_guard<std::mutex> lock(commitQueue.mutex);
+      commitQueue.retryScheduled = false;
+    }
+    commitInOrder(envelope);
+  });
+}
+
+void catchUp();
+bool commitIsCertified(const ContextPtr &context, ConsensusEnvelope &envelope);
+
+// Skipping a round would leave this ledger different from those that got
+// it, so every later commit waits until it turns up. A commit notice may
+// just be late; once order_gap_timeout_millis has passed, the round is
+// fetched from the other peers. Called with commitQueue.mutex held.
+void scheduleCatchUp() {
+  if (commitQueue.catchUpScheduled) {
+    return;
+  }
+  commitQueue.catchUpScheduled = true;
+  setAwkTimer(orderGapTimeout().count(), catchUp);
+}
+
+// Fetches the missing rounds one by one, taking each only with a valid
+// commit certificate, until the reorder buffer can move on.
+void catchUp() {
+  std::uint64_t missing;
+  {
+    std::lock_guard<std::mutex> lock(commitQueue.mutex);
+    commitQueue.catchUpScheduled = false;
+  }
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(commitQueue.mutex);
+      const auto &buffer = commitQueue.reorderBuffer;
+      missing = commitQueue.lastCommitted + 1;
+      if (buffer.empty() || buffer.begin()->first == missing) {
+        return;
+      }
+    }
+    auto context = snapshot();
+    bool fetched = false;
+    for (auto &&peer : context->validatingPeers) {
+      if (peer->ip == ::peer::myself::getIp()) {
+        continue;
+      }
+      ConsensusEvent event;
+      if (!connection::iroha::Sumeragi::Commit::fetch(peer->ip, missing,
+                                                      event)) {
+        continue;
+      }
+      auto envelope = makeEnvelope(std::move(event));
+      if (!commitIsCertified(context, envelope)) {
+        logger::warning("sumeragi") << peer->ip << " sent round " << missing
+                                    << " without a valid certificate";
+        continue;
+      }
+      logger::info("sumeragi") << "fetched round " << missing << " from "
+                               << peer->ip;
+      commitInOrder(envelope);
+      fetched = true;
+      break;
+    }
+    if (!fetched) {
+      logger::error("sumeragi") << "still missing round " << missing
+                                << ", no peer could supply it";
+      std::lock_guard<std::mutex> lock(commitQueue.mutex);
+      scheduleCatchUp();
+      return;
+    }
+  }
+}
+
+// Commits are applied strictly by order, whatever order they arrive in.
+void commitInOrder(const ConsensusEnvelope &envelope) {
+  const auto &event = envelope.event;
+  std::vector<ConsensusEnvelope> resumed;
+  {
+    std::lock_guard<std::mutex> lock(commitQueue.mutex);
+    auto &buffer = commitQueue.reorderBuffer;
+    auto &lastCommitted = commitQueue.lastCommitted;
+    if (event.order() <= lastCommitted) {
+      return;
+    }
+    if (event.order() > lastCommitted + commitBufferCapacity()) {
+      logger::warning("sumeragi") << "commit of round " << event.order()
+                                  << " is too far ahead, dropped";
+      return;
+    }
+    auto placed = buffer.emplace(event.order(), envelope);
+    if (!placed.second && placed.first->second.digest != envelope.digest) {
+      logger::error("sumeragi") << "conflicting commits for round "
+                                << event.order() << ": kept "
+                                << placed.first->second.digest << ", got "
+                                << envelope.digest;
+    }
+
+    while (!buffer.empty() && buffer.begin()->first == lastCommitted + 1) {
+      if (!applyCommit(buffer.begin()->second)) {
+        retryCommit(buffer.begin()->second);
+        break;
+      }
+      lastCommitted = buffer.begin()->first;
+      logger::explore("sumeragi") << "committed order:" << lastCommitted;
+      buffer.erase(buffer.begin());
+    }
+
+    if (!buffer.empty() && buffer.begin()->first != lastCommitted + 1) {
+      scheduleCatchUp();
+    }
+
+    auto &deferred = commitQueue.deferred;
+    auto ready = deferred.upper_bound(lastCommitted + pipelineWindow());
+    for (auto it = deferred.begin(); it != ready; ++it) {
+      if (it->first > lastCommitted) {
+        resumed.push_back(std::move(it->second));
+      }
+    }
+    deferred.erase(deferred.begin(), ready);
+  }
+
+  for (auto &&round : resumed) {
+    std::function<void()> &&task = std::bind(processEnvelope, round);
+    pool.process(std::move(task));
+  }
+}
+
+// Raw signature over digest with this peer's key, decoded once.
+std::string signRaw(const std::string &digest) {
+  static const auto publicKey = base64::decode(::peer::myself::getPublicKey());
+  static const auto privateKey =
+      base64::decode(::peer::myself::getPrivateKey());
+  auto raw = signature::sign(digest, publicKey, privateKey);
+  return std::string(raw.begin(), raw.end());
+}
+
+/**
+ * Signer indices only mean something for one peer set version. The leader
+ * fixes it for a round; a peer on another version can neither sign nor
+ * count, and the round times out as it would with a missing signer.
+ */
+bool sameSigners(const ContextPtr &context, const SignatureSet &set) {
+  return signature_set::count(set) == 0 ||
+         set.peersetversion() == context->peers->version;
+}
+
+// Our own signature needs no verification.
+void addOwnSignature(const ContextPtr &context, ConsensusEnvelope &envelope) {
+  auto &set = *envelope.event.mutable_signatureset();
+  if (!sameSigners(context, set)) {
+    logger::warning("sumeragi") << "round " << envelope.event.order()
+                                << " is signed for peer set version "
+                                << set.peersetversion();
+    return;
+  }
+  if (!context->isSigner() ||
+      signature_set::contains(set, context->myIndex)) {
+    return;
+  }
+  set.set_peersetversion(context->peers->version);
+  envelope.verified.set_peersetversion(context->peers->version);
+  auto raw = signRaw(envelope.digest);
+  signature_set::add(set, context->myIndex, raw);
+  signature_set::add(envelope.verified, context->myIndex, raw);
+}
+
+// Distinct peers with a valid signature; only new signatures are verified.
+std::uint32_t countValidSignatures(const ContextPtr &context,
+                                   ConsensusEnvelope &envelope) {
+  const auto &set = envelope.event.signatureset();
+  auto &verified = envelope.verified;
+  if (!sameSigners(context, set)) {
+    return 0;
+  }
+  verified.set_peersetversion(set.peersetversion());
+
+  SignatureSet unchecked;
+  unchecked.set_peersetversion(set.peersetversion());
+  const auto signers = signature_set::signers(set);
+  if (signers.size() != signature_set::count(set)) {
+    return 0;
+  }
+  for (std::size_t i = 0; i < signers.size(); i++) {
+    if (!signature_set::contains(verified, signers[i])) {
+      signature_set::add(unchecked, signers[i], set.signatures(i));
+    }
+  }
+  if (signature_set::count(unchecked) > 0) {
+    auto valid = signature_verifier::verify(unchecked, envelope.digest,
+                                            context->publicKeys);
+    const auto uncheckedSigners = signature_set::signers(unchecked);
+    for (std::size_t i = 0; i < valid.size(); i++) {
+      if (valid[i]) {
+        signature_set::add(verified, uncheckedSigners[i],
+                           unchecked.signatures(i));
+      }
+    }
+  }
+  return signature_set::count(verified);
 }
 
 bool eventSignatureIsEmpty(const ConsensusEvent &event) {
-  return event.eventsignatures_size() == 0;
+  return signature_set::count(event.signatureset()) == 0;
 }
 
 void printIsSumeragi(bool isSumeragi) {
@@ -147,46 +895,216 @@ void printReject() {
   logger::explore("sumeragi") << "\033[91m|+-ーー-+|\033[0m";
   logger::explore("sumeragi") << "\033[91m+==ーー==+\033[0m";
 }
-} // namespace detail
 
-struct Context {
-  bool isSumeragi;         // am I the leader or am I not?
-  std::uint64_t maxFaulty; // f
-  std::uint64_t proxyTailNdx;
-  std::int32_t panicCount;
-  std::int64_t commitedCount = 0;
-  std::uint64_t numValidatingPeers;
-  std::string myPublicKey;
-  peer::Nodes validatingPeers;
+bool isProxyTail(const ContextPtr &context) {
+  return context->validatingPeers.at(context->proxyTailNdx)->publicKey ==
+         context->myPublicKey;
+}
 
-  Context() { update(); }
+bool isCommitted(std::uint64_t order) {
+  std::lock_guard<std::mutex> lock(commitQueue.mutex);
+  return order <= commitQueue.lastCommitted;
+}
 
-  void update() {
-    logger::debug("sumeragi") << "Context update!";
-    validatingPeers = ::peer::service::getPeerList();
+// Votes for rounds this far ahead are not kept track of.
+bool isTooFarAhead(std::uint64_t order) {
+  std::lock_guard<std::mutex> lock(commitQueue.mutex);
+  return order > commitQueue.lastCommitted + commitBufferCapacity();
+}
 
-    numValidatingPeers = validatingPeers.size();
-    // maxFaulty = Default to approx. 1/3 of the network.
-    maxFaulty = ::peer::service::getMaxFaulty();
-    proxyTailNdx = this->maxFaulty * 2 + 1;
+ConsensusVote makeVote(const ContextPtr &context,
+                       const ConsensusEnvelope &envelope) {
+  ConsensusVote vote;
+  vote.set_digest(envelope.digest);
+  vote.set_order(envelope.event.order());
+  vote.set_peersetversion(context->peers->version);
+  vote.set_signer(context->myIndex);
+  vote.set_signature(signRaw(envelope.digest));
+  return vote;
+}
 
-    if (validatingPeers.empty()) {
-      logger::error("sumeragi") << "could not find any validating peers.";
-      exit(EXIT_FAILURE);
+// A body only counts if the leader of that peer set signed it; anyone else
+// could send a second body for the same order.
+bool leaderSigned(const ContextPtr &context,
+                  const ConsensusEnvelope &envelope) {
+  const auto &set = envelope.event.signatureset();
+  if (set.peersetversion() != context->peers->version) {
+    return false;
+  }
+  const auto signers = signature_set::signers(set);
+  for (std::size_t i = 0; i < signers.size(); i++) {
+    if (signers[i] == context->leaderIndex) {
+      return signature_verifier::verifyRaw(
+          set.signatures(i), envelope.digest,
+          context->publicKeys[context->leaderIndex]);
     }
+  }
+  return false;
+}
 
-    if (proxyTailNdx >= validatingPeers.size()) {
-      proxyTailNdx = validatingPeers.size() - 1;
+bool voteIsValid(const ContextPtr &context, const ConsensusVote &vote) {
+  return vote.peersetversion() == context->peers->version &&
+         vote.signer() < context->publicKeys.size() &&
+         signature_verifier::verifyRaw(vote.signature(), vote.digest(),
+                                       context->publicKeys[vote.signer()]);
+}
+
+// Fills valid with the signatures of the certificate that check out.
+bool certificateIsValid(const ContextPtr &context,
+                        const CommitCertificate &certificate,
+                        SignatureSet &valid) {
+  const auto &set = certificate.signatures();
+  if (set.peersetversion() != context->peers->version ||
+      !signature_set::wellFormed(set, context->publicKeys.size())) {
+    return false;
+  }
+  auto bitmap = signature_verifier::verify(set, certificate.digest(),
+                                           context->publicKeys);
+  const auto signers = signature_set::signers(set);
+  valid.set_peersetversion(set.peersetversion());
+  for (std::size_t i = 0; i < bitmap.size(); i++) {
+    if (bitmap[i]) {
+      signature_set::add(valid, signers[i], set.signatures(i));
     }
+  }
+  return signature_set::count(valid) >= context->maxFaulty * 2 + 1;
+}
 
-    panicCount = 0;
-    myPublicKey = ::peer::myself::getPublicKey();
+// Full protocol: a committed event is only taken with 2f+1 valid signatures
+// over its digest from the current peer set; they end up in verified.
+bool commitIsCertified(const ContextPtr &context, ConsensusEnvelope &envelope) {
+  const auto &set = envelope.event.signatureset();
+  if (set.peersetversion() != context->peers->version) {
+    return false;
+  }
+  return countValidSignatures(context, envelope) >= context->maxFaulty * 2 + 1;
+}
 
-    isSumeragi = validatingPeers.at(0)->publicKey == myPublicKey;
+/**
+ * Commits the round once it has its body and either a certificate or, on
+ * the proxy tail, 2f+1 votes. The committed event carries the votes as its
+ * signature set, so storage does not depend on the protocol.
+ */
+void commitIfReady(const ContextPtr &context, std::unique_lock<std::mutex> &lock,
+                   VoteRound &round) {
+  if (!round.hasBody || round.committed ||
+      (!round.certified &&
+       signature_set::count(round.signatures) < context->maxFaulty * 2 + 1)) {
+    return;
   }
-};
+  round.committed = true;
+
+  auto envelope = round.envelope;
+  auto &event = envelope.event;
+  *event.mutable_signatureset() = round.signatures;
+  envelope.verified = round.signatures;
+  event.set_status("commited");
+  CommitCertificate certificate;
+  certificate.set_digest(envelope.digest);
+  certificate.set_order(event.order());
+  *certificate.mutable_signatures() = round.signatures;
+  const bool announce = !round.certified;
+  lock.unlock();
+
+  logger::explore("sumeragi") << "commit order:" << event.order() << " with "
+                              << signature_set::count(envelope.verified)
+                              << " votes";
+  commitInOrder(envelope);
+  if (announce) {
+    connection::iroha::Sumeragi::Commit::sendAll(certificate);
+  }
+}
 
-std::unique_ptr<Context> context = nullptr;
+// Returns false if the body was already here.
+bool recordBody(const ContextPtr &context, const ConsensusEnvelope &envelope) {
+  std::unique_lock<std::mutex> lock(voteRounds.mutex);
+  auto &round = voteRounds.byDigest[envelope.digest];
+  if (round.hasBody) {
+    return false;
+  }
+  round.order = envelope.event.order();
+  round.hasBody = true;
+  round.envelope = envelope;
+  commitIfReady(context, lock, round);
+  return true;
+}
+
+// Returns false, and keeps its first vote, if this peer already voted for
+// another digest at the same order.
+bool claimVote(const ConsensusEnvelope &envelope) {
+  std::lock_guard<std::mutex> lock(voteRounds.mutex);
+  auto placed =
+      voteRounds.ownVotes.emplace(envelope.event.order(), envelope.digest);
+  if (!placed.second && placed.first->second != envelope.digest) {
+    logger::error("sumeragi") << "second body for order "
+                              << envelope.event.order() << ", not voting";
+    return false;
+  }
+  return placed.second;
+}
+
+void recordVote(const ContextPtr &context, const ConsensusVote &vote) {
+  std::unique_lock<std::mutex> lock(voteRounds.mutex);
+  auto &voted = voteRounds.votes[vote.order()];
+  auto placed = voted.emplace(vote.signer(), vote.digest());
+  if (!placed.second && placed.first->second != vote.digest()) {
+    logger::warning("sumeragi") << "signer " << vote.signer()
+                                << " voted twice for order " << vote.order();
+    return;
+  }
+  auto &round = voteRounds.byDigest[vote.digest()];
+  round.order = vote.order();
+  round.signatures.set_peersetversion(vote.peersetversion());
+  signature_set::add(round.signatures, vote.signer(), vote.signature());
+  commitIfReady(context, lock, round);
+}
+
+void recordCertificate(const ContextPtr &context,
+                       const CommitCertificate &certificate,
+                       const SignatureSet &valid) {
+  std::unique_lock<std::mutex> lock(voteRounds.mutex);
+  auto &round = voteRounds.byDigest[certificate.digest()];
+  round.order = certificate.order();
+  round.certified = true;
+  round.signatures = valid;
+  commitIfReady(context, lock, round);
+}
+
+void processVoteRound(const ContextPtr &context, ConsensusEnvelope &envelope) {
+  auto &event = envelope.event;
+  if (context->isSumeragi && eventSignatureIsEmpty(event)) {
+    // the only time the body goes over the wire
+    addOwnSignature(context, envelope);
+    connection::iroha::Sumeragi::Verify::sendAll(event);
+  }
+  if (!leaderSigned(context, envelope)) {
+    logger::warning("sumeragi") << "body for order " << event.order()
+                                << " is not signed by the leader";
+    return;
+  }
+  if (!recordBody(context, envelope) || !context->isSigner() ||
+      !claimVote(envelope)) {
+    return;
+  }
+
+  auto vote = makeVote(context, envelope);
+  if (isProxyTail(context)) {
+    recordVote(context, vote);
+  } else {
+    connection::iroha::Sumeragi::Vote::send(
+        context->validatingPeers.at(context->proxyTailNdx)->ip, vote);
+  }
+
+  watchRound(envelope.digest,
+             setAwkTimer(3000, [digest = envelope.digest, event]() {
+               unwatchRound(digest);
+               if (!merkle_transaction_repository::leafExists(digest)) {
+                 panic(event);
+               }
+             }));
+}
+
+} // namespace detail
 
 void initializeSumeragi() {
   logger::explore("sumeragi") << "\033[95m+==ーーーーーーーーー==+\033[0m";
@@ -206,39 +1124,69 @@ void initializeSumeragi() {
   logger::info("sumeragi") << "Sumeragi setted";
   logger::info("sumeragi") << "set number of validatingPeer";
 
-  context = std::make_unique<Context>();
+  auto context = detail::snapshot();
+  detail::commitQueue.lastCommitted =
+      merkle_transaction_repository::getLastLeafOrder();
 
-  connection::iroha::Sumeragi::Torii::receive(
-      [](const std::string &from, Transaction &transaction) {
+  // Every peer buffers what its Torii receives; only the leader cuts
+  // blocks, the others hand batches over to it.
+  connection::iroha::Sumeragi::Torii::admit(
+      [](const std::string &from, const Transaction &transaction,
+         StatusResponse &response) {
         logger::info("sumeragi") << "receive! Torii";
-        ConsensusEvent event;
-        event.set_status("uncommit");
-        event.mutable_transaction()->CopyFrom(transaction);
-        context->update();
-        // send processTransaction(event) as a task to processing pool
-        // this returns std::future<void> object
-        // (std::future).get() method locks processing until result of
-        // processTransaction will be available
-        // but processTransaction returns void, so we don't have to call it and
-        // wait
-        std::function<void()> &&task = std::bind(processTransaction, event);
-        pool.process(std::move(task));
+        // the only time this transaction is hashed on this peer
+        auto digest = hashTransaction(transaction);
+        // stateless checks first, so spam never reaches the mempool; this
+        // already runs on a gRPC worker, so they run right here
+        auto verdict = prevalidation::check(transaction, digest);
+        if (verdict != prevalidation::Verdict::VALID) {
+          logger::info("sumeragi") << "rejected: " << prevalidation::describe(verdict);
+          response.set_message(prevalidation::describe(verdict));
+          return false;
+        }
+        // then against cached world state, if admission_strictness allows
+        auto admitted = admission::check(transaction);
+        if (admitted != admission::Verdict::ADMIT) {
+          logger::info("sumeragi") << "rejected: " << admission::describe(admitted);
+          response.set_message(admission::describe(admitted));
+          return false;
+        }
+        auto result = enqueueTransaction(transaction, digest);
+        if (result.status == mempool::Admission::ACCEPTED) {
+          return true;
+        }
+        logger::info("sumeragi") << "rejected: " << mempool::describe(result.status);
+        response.set_message(mempool::describe(result.status));
+        response.set_retryaftermillis(result.retryAfter.count());
+        return false;
       });
 
   connection::iroha::Sumeragi::Verify::receive([](const std::string &from,
                                                   ConsensusEvent &event) {
     logger::info("sumeragi") << "receive!";
+    if (!signature_set::wellFormed(event.signatureset(),
+                                   detail::snapshot()->publicKeys.size())) {
+      logger::warning("sumeragi") << "dropped an event with a malformed "
+                                     "signature set";
+      return;
+    }
     logger::info("sumeragi") << "received message! sig:["
-                             << event.eventsignatures_size() << "]";
+                             << event.signatureset().signatures_size() << "]";
     logger::info("sumeragi") << "received message! status:[" << event.status()
                              << "]";
     if (event.status() == "commited") {
-      if (txCache.find(detail::hash(event.transaction())) == txCache.end()) {
-        txCache[detail::hash(event.transaction())] = "commited";
-        repository::transaction::add(detail::hash(event.transaction()),
-                                     event.transaction());
-        executor::execute(event.transaction());
-      }
+      // checked on the pool, so a forged commit can neither hold up this
+      // thread nor take the order's slot in the reorder buffer
+      auto envelope = makeEnvelope(std::move(event));
+      std::function<void()> task = [envelope]() mutable {
+        if (!detail::commitIsCertified(detail::snapshot(), envelope)) {
+          logger::warning("sumeragi") << "dropped an uncertified commit of round "
+                                      << envelope.event.order();
+          return;
+        }
+        detail::commitInOrder(envelope);
+      };
+      pool.process(std::move(task));
     } else {
       // send processTransaction(event) as a task to processing pool
       // this returns std::future<void> object
@@ -251,13 +1199,27 @@ void initializeSumeragi() {
     }
   });
 
+  connection::iroha::Sumeragi::Vote::receive([](const std::string &from,
+                                                ConsensusVote &vote) {
+    std::function<void()> task = [vote]() { processVote(vote); };
+    pool.process(std::move(task));
+  });
+
+  connection::iroha::Sumeragi::Commit::receive(
+      [](const std::string &from, CommitCertificate &certificate) {
+        std::function<void()> task = [certificate]() {
+          processCommit(certificate);
+        };
+        pool.process(std::move(task));
+      });
+
   logger::info("sumeragi") << "initialize numValidatingPeers :"
                            << context->numValidatingPeers;
   logger::info("sumeragi") << "initialize maxFaulty :" << context->maxFaulty;
   logger::info("sumeragi") << "initialize proxyTailNdx :"
                            << context->proxyTailNdx;
 
-  logger::info("sumeragi") << "initialize panicCount :" << context->panicCount;
+  logger::info("sumeragi") << "initialize panicCount :" << detail::panicCount;
   logger::info("sumeragi") << "initialize myPublicKey :"
                            << context->myPublicKey;
 
@@ -265,17 +1227,114 @@ void initializeSumeragi() {
   // determineConsensusOrder(); // side effect is to modify validatingPeers
   logger::info("sumeragi") << "initialize is sumeragi :"
                            << static_cast<int>(context->isSumeragi);
+
+  // Health checks share the consensus pool; 0 turns them off.
+  const auto checkInterval =
+      config::IrohaConfigManager::getInstance().getHijiriCheckIntervalMillis(
+          5000);
+  if (checkInterval > 0) {
+    for (auto &&peer : context->validatingPeers) {
+      if (peer->ip != ::peer::myself::getIp()) {
+        ::peer::hijiri::startCheck(
+            peer->ip, static_cast<int>(checkInterval),
+            [](std::function<void()> check) { pool.process(std::move(check)); });
+      }
+    }
+  }
+
+  std::thread(loop).detach();
+
   logger::info("sumeragi") << "initialize.....  complete!";
 }
 
+mempool::Result enqueueTransaction(const Transaction &tx,
+                                   const std::string &digest) {
+  if (detail::alreadyCommitted(digest)) {
+    return {mempool::Admission::DUPLICATE, std::chrono::milliseconds(0)};
+  }
+  auto &mempool = detail::transactionPool();
+  auto result = mempool.add(tx, digest);
+  if (result.status != mempool::Admission::ACCEPTED) {
+    return result;
+  }
+  detail::openPendingBlock();
+  if (mempool.size() >= detail::blockMaxTransactions()) {
+    detail::cutBlock();
+  }
+  return result;
+}
+
+void flushBlock() { detail::cutBlock(); }
+
+void loop() {
+  auto &pending = detail::pendingBlock;
+  std::unique_lock<std::mutex> lock(pending.mutex);
+  while (true) {
+    if (!pending.open) {
+      pending.arrived.wait(lock);
+      continue;
+    }
+    auto deadline = pending.openedAt + detail::blockMaxWait();
+    if (std::chrono::steady_clock::now() < deadline) {
+      pending.arrived.wait_until(lock, deadline);
+      continue;
+    }
+    // cutBlock opens the next one if anything is left
+    pending.open = false;
+    lock.unlock();
+    detail::cutBlock();
+    lock.lock();
+  }
+}
+
+dedup::Stats getDedupStats() { return detail::txCache().stats(); }
+
+mempool::Stats getMempoolStats() { return detail::transactionPool().stats(); }
+
 std::uint64_t getNextOrder() {
-  return 0l;
-  // return merkle_transaction_repository::getLastLeafOrder() + 1;
+  auto &lastAssigned = detail::lastAssigned;
+  std::uint64_t lastCommitted;
+  {
+    std::lock_guard<std::mutex> lock(detail::commitQueue.mutex);
+    lastCommitted = detail::commitQueue.lastCommitted;
+  }
+  // Rounds that were in flight when this peer lost leadership or restarted
+  // are superseded by the persisted commit order.
+  auto expected = lastAssigned.load();
+  std::uint64_t next;
+  do {
+    next = std::max(expected, lastCommitted) + 1;
+  } while (!lastAssigned.compare_exchange_weak(expected, next));
+  return next;
 }
 
 void processTransaction(ConsensusEvent &event) {
+  auto envelope = makeEnvelope(std::move(event));
+  processEnvelope(envelope);
+}
+
+void processEnvelope(ConsensusEnvelope &envelope) {
 
   logger::info("sumeragi") << "processTransaction";
+  if (!detail::admitRound(envelope)) {
+    return;
+  }
+  if (detail::voteProtocol()) {
+    detail::processVoteRound(detail::snapshot(), envelope);
+    return;
+  }
+  if (!detail::joinRound(envelope)) {
+    return;
+  }
+  do {
+    processSignatures(envelope);
+  } while (detail::leaveRound(envelope));
+}
+
+void processSignatures(ConsensusEnvelope &envelope) {
+  auto context = detail::snapshot();
+  auto &event = envelope.event;
+  const auto &digest = envelope.digest;
   // if (!transaction_validator::isValid(event->getTx())) {
   //    return; //TODO-futurework: give bad trust rating to nodes that sent an
   //    invalid event
@@ -283,31 +1342,18 @@ void processTransaction(ConsensusEvent &event) {
   logger::info("sumeragi") << "valid";
   logger::info("sumeragi") << "Add my signature...";
 
-  logger::info("sumeragi") << "hash:" << detail::hash(event.transaction());
+  logger::info("sumeragi") << "hash:" << digest;
   logger::info("sumeragi") << "pub: " << ::peer::myself::getPublicKey();
   logger::info("sumeragi") << "priv:" << ::peer::myself::getPrivateKey();
-  logger::info("sumeragi") << "sig: "
-                           << signature::sign(detail::hash(event.transaction()),
-                                              ::peer::myself::getPublicKey(),
-                                              ::peer::myself::getPrivateKey());
 
   // detail::printIsSumeragi(context->isSumeragi);
   // Really need? blow "if statement" will be false anytime.
-  detail::addSignature(event, ::peer::myself::getPublicKey(),
-                       signature::sign(detail::hash(event.transaction()),
-                                       ::peer::myself::getPublicKey(),
-                                       ::peer::myself::getPrivateKey()));
-
-  if (detail::eventSignatureIsEmpty(event) && context->isSumeragi) {
-    logger::info("sumeragi") << "signatures.empty() isSumragi";
-    // Determine the order for processing this event
-    event.set_order(getNextOrder()); // TODO getNexOrder is always return 0l;
-    logger::info("sumeragi") << "new  order:" << event.order();
-  } else if (!detail::eventSignatureIsEmpty(event)) {
+  detail::addOwnSignature(context, envelope);
+
+  if (!detail::eventSignatureIsEmpty(event)) {
     // Check if we have at least 2f+1 signatures needed for Byzantine fault
     // tolerance
-    if (transaction_validator::countValidSignatures(event) >=
-        context->maxFaulty * 2 + 1) {
+    if (detail::countValidSignatures(context, envelope) >= context->maxFaulty * 2 + 1) {
 
       logger::info("sumeragi") << "Signature exists";
 
@@ -318,12 +1364,12 @@ void processTransaction(ConsensusEvent &event) {
       logger::explore("sumeragi") << "\033[93m0================================"
                                      "================================0\033[0m";
       logger::explore("sumeragi") << "\033[93m0\033[1m"
-                                  << detail::hash(event.transaction())
+                                  << digest
                                   << "0\033[0m";
       logger::explore("sumeragi") << "\033[93m0================================"
                                      "================================0\033[0m";
 
-      detail::printJudge(transaction_validator::countValidSignatures(event),
+      detail::printJudge(detail::countValidSignatures(context, envelope),
                          context->numValidatingPeers,
                          context->maxFaulty * 2 + 1);
 
@@ -334,24 +1380,16 @@ void processTransaction(ConsensusEvent &event) {
       // Try applying transaction locally and compute the merkle root
 
       // Commit locally
-      logger::explore("sumeragi") << "commit";
+      logger::explore("sumeragi") << "commit order:" << event.order();
 
-      context->commitedCount++;
-
-      logger::explore("sumeragi") << "commit count:" << context->commitedCount;
-
-      merkle_transaction_repository::commit(
-          event); // TODO: add error handling in case not saved
       event.set_status("commited");
-      connection::iroha::Sumeragi::Verify::sendAll(std::move(event));
+      detail::commitInOrder(envelope);
+      // every peer has to hear about the commit, so no quorum here
+      connection::iroha::Sumeragi::Verify::sendAll(event);
 
     } else {
       // This is a new event, so we should verify, sign, and broadcast it
-      detail::addSignature(event, ::peer::myself::getPublicKey(),
-                           signature::sign(detail::hash(event.transaction()),
-                                           ::peer::myself::getPublicKey(),
-                                           ::peer::myself::getPrivateKey())
-                               .c_str());
+      detail::addOwnSignature(context, envelope);
 
       logger::info("sumeragi")
           << "tail public key is "
@@ -367,25 +1405,61 @@ void processTransaction(ConsensusEvent &event) {
             << context->validatingPeers.at(context->proxyTailNdx)->ip;
         connection::iroha::Sumeragi::Verify::send(
             context->validatingPeers.at(context->proxyTailNdx)->ip,
-            std::move(event)); // Think In Process
+            event); // Think In Process
       } else {
         logger::info("sumeragi")
-            << "Send All! sig:["
-            << transaction_validator::countValidSignatures(event) << "]";
+            << "Send All! sig:[" << detail::countValidSignatures(context, envelope)
+            << "]";
+        // Every peer is asked at once; once 2f+1 have confirmed, the
+        // stragglers are not waited for.
         connection::iroha::Sumeragi::Verify::sendAll(
-            std::move(event)); // TODO: Think In Process
+            event, context->maxFaulty * 2 + 1); // TODO: Think In Process
       }
 
-      setAwkTimer(3000, [&]() {
-        if (!merkle_transaction_repository::leafExists(
-                detail::hash(event.transaction()))) {
-          panic(event);
+      // The timer owns its copy of the round; processTransaction has long
+      // returned by the time it fires.
+      detail::watchRound(digest, setAwkTimer(3000, [envelope]() {
+        detail::unwatchRound(envelope.digest);
+        if (!merkle_transaction_repository::leafExists(envelope.digest)) {
+          panic(envelope.event);
         }
-      });
+      }));
     }
   }
 }
 
+void processVote(const ConsensusVote &vote) {
+  auto context = detail::snapshot();
+  if (!detail::isProxyTail(context)) {
+    logger::warning("sumeragi") << "vote for order " << vote.order()
+                                << " reached a peer that is not the tail";
+    return;
+  }
+  if (detail::isCommitted(vote.order()) || detail::isTooFarAhead(vote.order())) {
+    return;
+  }
+  if (!detail::voteIsValid(context, vote)) {
+    logger::warning("sumeragi") << "invalid vote from signer " << vote.signer()
+                                << " for order " << vote.order();
+    return;
+  }
+  detail::recordVote(context, vote);
+}
+
+void processCommit(const CommitCertificate &certificate) {
+  if (detail::isCommitted(certificate.order())) {
+    return;
+  }
+  auto context = detail::snapshot();
+  SignatureSet valid;
+  if (!detail::certificateIsValid(context, certificate, valid)) {
+    logger::warning("sumeragi") << "invalid commit certificate for order "
+                                << certificate.order();
+    return;
+  }
+  detail::recordCertificate(context, certificate, valid);
+}
+
 /**
 *
 * For example, given:
@@ -406,9 +1480,11 @@ void processTransaction(ConsensusEvent &event) {
 * |---|  |---|  |---|  |---|  |---|  |---|.
 */
 void panic(const ConsensusEvent &event) {
-  context->panicCount++; // TODO: reset this later
+  auto context = detail::snapshot();
+  // back to 0 once a round commits
+  auto panicCount = ++detail::panicCount;
   auto broadcastStart =
-      2 * context->maxFaulty + 1 + context->maxFaulty * context->panicCount;
+      2 * context->maxFaulty + 1 + context->maxFaulty * panicCount;
   auto broadcastEnd = broadcastStart + context->maxFaulty;
 
   // Do some bounds checking
@@ -427,14 +1503,14 @@ void panic(const ConsensusEvent &event) {
   // only broadcast to peer range between broadcastStart and broadcastEnd
 }
 
-void setAwkTimer(int const sleepMillisecs,
-                 std::function<void(void)> const action) {
-  //    std::thread([action, sleepMillisecs]() {
-  //        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMillisecs));
-  //        action();
-  //    }).join();
-  std::this_thread::sleep_for(std::chrono::milliseconds(sleepMillisecs));
-  action();
+// Fires on the shared timer wheel and runs the action on the consensus pool,
+// so neither the caller nor the timer thread waits on it.
+timer::TimerId setAwkTimer(int const sleepMillisecs,
+                           std::function<void(void)> const action) {
+  return timer::schedule(std::chrono::milliseconds(sleepMillisecs), [action]() {
+    std::function<void()> task = action;
+    pool.process(std::move(task));
+  });
 }
 
 /**
@@ -476,8 +1552,7 @@ void determineConsensusOrder() {
   peer->ip;
   }
   */
-  context->isSumeragi =
-      context->validatingPeers.at(0)->publicKey == context->myPublicKey;
-    }
+  // isSumeragi is worked out with every Context
+}
 
 };  // namespace sumeragi
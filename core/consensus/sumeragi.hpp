@@ -25,25 +25,54 @@ limitations under the License.
 #include <memory>
 
 #include "consensus_event.hpp"
+#include "consensus_envelope.hpp"
+#include "mempool.hpp"
 
 #include <service/peer_service.hpp>
 #include <infra/protobuf/api.grpc.pb.h>
+#include <util/dedup_cache.hpp>
+#include <util/timer_wheel.hpp>
 
 namespace sumeragi {
 
+    using Api::CommitCertificate;
     using Api::ConsensusEvent;
+    using Api::ConsensusVote;
+    using Api::Transaction;
 
     void initializeSumeragi();
+    // Cuts the pending block once it has waited block_max_wait_millis.
     void loop();
 
-    void getNextOrder(
-        const ConsensusEvent& event
-    );
+    // Admits the transaction into the mempool under its digest, as worked
+    // out by hashTransaction; anything but ACCEPTED is a rejection, with a
+    // retry hint when the mempool is full.
+    mempool::Result enqueueTransaction(const Transaction& tx,
+                                       const std::string& digest);
+    void flushBlock();
 
+    // Hit and eviction counts of the committed-transaction dedup cache.
+    dedup::Stats getDedupStats();
+    // Queue depths and admission counts of the mempool.
+    mempool::Stats getMempoolStats();
+
+    // Leader-assigned round number, strictly increasing after the last commit.
+    std::uint64_t getNextOrder();
+
+    // Entry point for events from other peers; hashes them once on arrival.
     void processTransaction(ConsensusEvent& event);
+    // Merges copies of an event by digest before doing any work on them.
+    void processEnvelope(ConsensusEnvelope& envelope);
+    // Counts, signs and forwards the merged state of one round.
+    void processSignatures(ConsensusEnvelope& envelope);
+
+    // Vote-only protocol: a vote reaching the proxy tail, and the tail's
+    // certificate reaching everyone else.
+    void processVote(const ConsensusVote& vote);
+    void processCommit(const CommitCertificate& certificate);
 
     void panic(const ConsensusEvent& event);
-    void setAwkTimer(const int sleepMillisecs, const std::function<void(void)> action);
+    timer::TimerId setAwkTimer(const int sleepMillisecs, const std::function<void(void)> action);
     void determineConsensusOrder(/*std::vector<double> trustVector*/);
 
 };  // namespace sumeragi
@@ -57,6 +57,18 @@ std::string IrohaConfigManager::getJavaPolicyPath(const std::string& defaultValu
   return this->getParam<std::string>("java_policy_path", defaultValue);
 }
 
+std::string IrohaConfigManager::getGrpcServerMode(const std::string& defaultValue) {
+  return this->getParam<std::string>("grpc_server_mode", defaultValue);
+}
+
+std::string IrohaConfigManager::getConsensusTransport(const std::string& defaultValue) {
+  return this->getParam<std::string>("consensus_transport", defaultValue);
+}
+
+std::string IrohaConfigManager::getConsensusProtocol(const std::string& defaultValue) {
+  return this->getParam<std::string>("consensus_protocol", defaultValue);
+}
+
 size_t IrohaConfigManager::getConcurrency(size_t defaultValue) {
   return this->getParam<size_t>("concurrency", defaultValue);
 }
@@ -79,4 +91,184 @@ uint16_t IrohaConfigManager::getHttpPortNumber(uint16_t defaultValue) {
 
 bool IrohaConfigManager::getActiveStart(bool defaultValue = false) {
     return this->getParam<bool>("active_start", defaultValue);
-}
\ No newline at end of file
+}
+
+size_t IrohaConfigManager::getBlockMaxTransactions(size_t defaultValue) {
+    return this->getParam<size_t>("block_max_transactions", defaultValue);
+}
+
+size_t IrohaConfigManager::getBlockMaxWaitMillis(size_t defaultValue) {
+    return this->getParam<size_t>("block_max_wait_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getPipelineWindow(size_t defaultValue) {
+    return this->getParam<size_t>("pipeline_window", defaultValue);
+}
+
+size_t IrohaConfigManager::getOrderGapTimeoutMillis(size_t defaultValue) {
+    return this->getParam<size_t>("order_gap_timeout_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getCommitBufferCapacity(size_t defaultValue) {
+    return this->getParam<size_t>("commit_buffer_capacity", defaultValue);
+}
+
+size_t IrohaConfigManager::getDedupCacheCapacity(size_t defaultValue) {
+    return this->getParam<size_t>("dedup_cache_capacity", defaultValue);
+}
+
+size_t IrohaConfigManager::getDedupCacheShards(size_t defaultValue) {
+    return this->getParam<size_t>("dedup_cache_shards", defaultValue);
+}
+
+size_t IrohaConfigManager::getDedupCacheBloomCounters(size_t defaultValue) {
+    return this->getParam<size_t>("dedup_cache_bloom_counters", defaultValue);
+}
+
+size_t IrohaConfigManager::getDedupRetainRounds(size_t defaultValue) {
+    return this->getParam<size_t>("dedup_retain_rounds", defaultValue);
+}
+
+size_t IrohaConfigManager::getVerifyConcurrency(size_t defaultValue) {
+    return this->getParam<size_t>("verify_concurrency", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcKeepaliveMillis(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_keepalive_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getHijiriCheckIntervalMillis(size_t defaultValue) {
+    return this->getParam<size_t>("hijiri_check_interval_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcKeepaliveTimeoutMillis(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_keepalive_timeout_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcReconnectBackoffMinMillis(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_reconnect_backoff_min_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcReconnectBackoffMaxMillis(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_reconnect_backoff_max_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcSendDeadlineMillis(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_send_deadline_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcServerCompletionQueues(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_server_completion_queues", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcServerThreadsPerQueue(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_server_threads_per_queue", defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcServerWorkers(size_t defaultValue) {
+    return this->getParam<size_t>("grpc_server_workers", defaultValue);
+}
+
+size_t IrohaConfigManager::getConsensusStreamMaxBatch(size_t defaultValue) {
+    return this->getParam<size_t>("consensus_stream_max_batch", defaultValue);
+}
+
+size_t IrohaConfigManager::getConsensusStreamLingerMicros(size_t defaultValue) {
+    return this->getParam<size_t>("consensus_stream_linger_micros", defaultValue);
+}
+
+size_t IrohaConfigManager::getConsensusStreamQueueLimit(size_t defaultValue) {
+    return this->getParam<size_t>("consensus_stream_queue_limit", defaultValue);
+}
+
+size_t IrohaConfigManager::getMempoolCapacity(size_t defaultValue) {
+    return this->getParam<size_t>("mempool_capacity", defaultValue);
+}
+
+size_t IrohaConfigManager::getMempoolSenderCapacity(size_t defaultValue) {
+    return this->getParam<size_t>("mempool_sender_capacity", defaultValue);
+}
+
+size_t IrohaConfigManager::getMempoolTtlMillis(size_t defaultValue) {
+    return this->getParam<size_t>("mempool_ttl_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getMempoolRetryAfterMillis(size_t defaultValue) {
+    return this->getParam<size_t>("mempool_retry_after_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getTxMaxBytes(size_t defaultValue) {
+    return this->getParam<size_t>("tx_max_bytes", defaultValue);
+}
+
+size_t IrohaConfigManager::getPrevalidationConcurrency(size_t defaultValue) {
+    return this->getParam<size_t>("prevalidation_concurrency", defaultValue);
+}
+
+bool IrohaConfigManager::getPrevalidationRequireSignature(bool defaultValue) {
+    return this->getParam<bool>("prevalidation_require_signature", defaultValue);
+}
+
+std::string IrohaConfigManager::getAdmissionStrictness(const std::string& defaultValue) {
+    return this->getParam<std::string>("admission_strictness", defaultValue);
+}
+
+size_t IrohaConfigManager::getAdmissionCacheTtlMillis(size_t defaultValue) {
+    return this->getParam<size_t>("admission_cache_ttl_millis", defaultValue);
+}
+
+size_t IrohaConfigManager::getAdmissionCacheCapacity(size_t defaultValue) {
+    return this->getParam<size_t>("admission_cache_capacity", defaultValue);
+}
+
+size_t IrohaConfigManager::getExecutorConcurrency(size_t defaultValue) {
+    return this->getParam<size_t>("executor_concurrency", defaultValue);
+}
+
+size_t IrohaConfigManager::getExecutorHotAccountPercent(size_t defaultValue) {
+    return this->getParam<size_t>("executor_hot_account_percent", defaultValue);
+}
+
+size_t IrohaConfigManager::getWorldStateCacheBytes(size_t defaultValue) {
+    return this->getParam<size_t>("world_state_cache_bytes", defaultValue);
+}
+
+size_t IrohaConfigManager::getWorldStateCacheShards(size_t defaultValue) {
+    return this->getParam<size_t>("world_state_cache_shards", defaultValue);
+}
+
+size_t IrohaConfigManager::getMultiGetFanoutThreshold(size_t defaultValue) {
+    return this->getParam<size_t>("multiget_fanout_threshold", defaultValue);
+}
+
+size_t IrohaConfigManager::getTransactionPageLimit(size_t defaultValue) {
+    return this->getParam<size_t>("transaction_page_limit", defaultValue);
+}
+
+std::string IrohaConfigManager::getLeveldbProfile(const std::string& defaultValue) {
+    return this->getParam<std::string>("leveldb_profile", defaultValue);
+}
+
+size_t IrohaConfigManager::getLeveldbBlockCacheBytes(size_t defaultValue) {
+    return this->getParam<size_t>("leveldb_block_cache_bytes", defaultValue);
+}
+
+size_t IrohaConfigManager::getLeveldbBloomBitsPerKey(size_t defaultValue) {
+    return this->getParam<size_t>("leveldb_bloom_bits_per_key", defaultValue);
+}
+
+size_t IrohaConfigManager::getLeveldbWriteBufferBytes(size_t defaultValue) {
+    return this->getParam<size_t>("leveldb_write_buffer_bytes", defaultValue);
+}
+
+size_t IrohaConfigManager::getLeveldbMaxOpenFiles(size_t defaultValue) {
+    return this->getParam<size_t>("leveldb_max_open_files", defaultValue);
+}
+
+size_t IrohaConfigManager::getLeveldbBlockSize(size_t defaultValue) {
+    return this->getParam<size_t>("leveldb_block_size", defaultValue);
+}
+
+std::string IrohaConfigManager::getLeveldbCompression(const std::string& defaultValue) {
+    return this->getParam<std::string>("leveldb_compression", defaultValue);
+}
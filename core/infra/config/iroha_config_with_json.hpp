@@ -38,12 +38,60 @@ class IrohaConfigManager : config::AbstractConfigManager {
   std::string getJavaLibraryPathLocal(const std::string& defaultValue);
 
   std::string getJavaPolicyPath(const std::string& defaultValue);
+  std::string getGrpcServerMode(const std::string& defaultValue);
+  std::string getConsensusTransport(const std::string& defaultValue);
+  std::string getConsensusProtocol(const std::string& defaultValue);
   size_t getConcurrency(size_t defaultValue);
   size_t getMaxFaultyPeers(size_t defaultValue);
   size_t getPoolWorkerQueueSize(size_t defaultValue);
   uint16_t getGrpcPortNumber(uint16_t defaultValue);
   uint16_t getHttpPortNumber(uint16_t defaultValue);
   bool getActiveStart(bool defaultValue);
+  size_t getBlockMaxTransactions(size_t defaultValue);
+  size_t getBlockMaxWaitMillis(size_t defaultValue);
+  size_t getPipelineWindow(size_t defaultValue);
+  size_t getOrderGapTimeoutMillis(size_t defaultValue);
+  size_t getCommitBufferCapacity(size_t defaultValue);
+  size_t getDedupCacheCapacity(size_t defaultValue);
+  size_t getDedupCacheShards(size_t defaultValue);
+  size_t getDedupCacheBloomCounters(size_t defaultValue);
+  size_t getDedupRetainRounds(size_t defaultValue);
+  size_t getVerifyConcurrency(size_t defaultValue);
+  size_t getGrpcKeepaliveMillis(size_t defaultValue);
+  size_t getHijiriCheckIntervalMillis(size_t defaultValue);
+  size_t getGrpcKeepaliveTimeoutMillis(size_t defaultValue);
+  size_t getGrpcReconnectBackoffMinMillis(size_t defaultValue);
+  size_t getGrpcReconnectBackoffMaxMillis(size_t defaultValue);
+  size_t getGrpcSendDeadlineMillis(size_t defaultValue);
+  size_t getGrpcServerCompletionQueues(size_t defaultValue);
+  size_t getGrpcServerThreadsPerQueue(size_t defaultValue);
+  size_t getGrpcServerWorkers(size_t defaultValue);
+  size_t getConsensusStreamMaxBatch(size_t defaultValue);
+  size_t getConsensusStreamLingerMicros(size_t defaultValue);
+  size_t getConsensusStreamQueueLimit(size_t defaultValue);
+  size_t getMempoolCapacity(size_t defaultValue);
+  size_t getMempoolSenderCapacity(size_t defaultValue);
+  size_t getMempoolTtlMillis(size_t defaultValue);
+  size_t getMempoolRetryAfterMillis(size_t defaultValue);
+  size_t getTxMaxBytes(size_t defaultValue);
+  size_t getPrevalidationConcurrency(size_t defaultValue);
+  bool getPrevalidationRequireSignature(bool defaultValue);
+  std::string getAdmissionStrictness(const std::string& defaultValue);
+  size_t getAdmissionCacheTtlMillis(size_t defaultValue);
+  size_t getAdmissionCacheCapacity(size_t defaultValue);
+  size_t getExecutorConcurrency(size_t defaultValue);
+  size_t getExecutorHotAccountPercent(size_t defaultValue);
+  size_t getWorldStateCacheBytes(size_t defaultValue);
+  size_t getWorldStateCacheShards(size_t defaultValue);
+  size_t getMultiGetFanoutThreshold(size_t defaultValue);
+  size_t getTransactionPageLimit(size_t defaultValue);
+  std::string getLeveldbProfile(const std::string& defaultValue);
+  size_t getLeveldbBlockCacheBytes(size_t defaultValue);
+  size_t getLeveldbBloomBitsPerKey(size_t defaultValue);
+  size_t getLeveldbWriteBufferBytes(size_t defaultValue);
+  size_t getLeveldbMaxOpenFiles(size_t defaultValue);
+  size_t getLeveldbBlockSize(size_t defaultValue);
+  std::string getLeveldbCompression(const std::string& defaultValue);
 };
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #include <grpc++/grpc++.h>
 
 #include <consensus/connection/connection.hpp>
+#include <consensus/consensus_envelope.hpp>
 #include <infra/config/iroha_config_with_json.hpp>
 #include <infra/config/peer_service_with_json.hpp>
 #include <service/peer_service.hpp>
@@ -25,13 +26,23 @@ limitations under the License.
 
 #include <repository/domain/account_repository.hpp>
 #include <repository/domain/asset_repository.hpp>
+#include <repository/consensus/merkle_transaction_repository.hpp>
 #include <repository/transaction_repository.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <thread_pool.hpp>
+
 using grpc::Channel;
 using grpc::Server;
 using grpc::ServerBuilder;
@@ -53,8 +64,14 @@ namespace connection {
 
     using Api::Query;
     using Api::ConsensusEvent;
+    using Api::ConsensusBatch;
+    using Api::ConsensusMessage;
+    using Api::ConsensusVote;
+    using Api::CommitCertificate;
+    using Api::CommitRequest;
     using Api::StatusResponse;
     using Api::Transaction;
+    using Api::TransactionBatch;
     using Api::TransactionResponse;
     using Api::AssetResponse;
     using Api::RecieverConfirmation;
@@ -86,10 +103,316 @@ namespace connection {
         return confirm;
     };
 
-    std::function<bool(const RecieverConfirmation&)> valid = [](const RecieverConfirmation &c) {
-        return signature::verify(c.signature().signature(), c.hash(), c.signature().publickey());
+    // A confirmation counts only if it signs the digest that was sent and
+    // comes from a validator of peers.
+    bool confirms(const RecieverConfirmation &c, const std::string &digest,
+                  const ::peer::PeerSet &peers) {
+        return c.hash() == digest
+            && std::binary_search(peers.signers.begin(), peers.signers.end(),
+                                  c.signature().publickey())
+            && signature::verify(c.signature().signature(), c.hash(), c.signature().publickey());
+    }
+
+    bool isStreamTransport() {
+        return config::IrohaConfigManager::getInstance().getConsensusTransport("unary") == "stream";
+    }
+
+    /**
+     * Long-lived, one-way Sumeragi.Stream to one other validator. Messages
+     * are queued and a writer thread coalesces whatever arrived within the
+     * linger time into one ConsensusBatch, so they reach the peer in the
+     * order they were sent, whatever their kind. The queue is bounded: a
+     * full queue blocks send() for up to the send deadline, and if it is
+     * still full send() returns false and the caller falls back to the
+     * unary rpc. HTTP/2 flow control throttles the writer when the peer
+     * falls behind.
+     */
+    class PeerStream {
+    public:
+        PeerStream(Sumeragi::Stub* stub, std::string ip)
+                : stub_(stub), ip_(std::move(ip)) {
+            auto& config = config::IrohaConfigManager::getInstance();
+            maxBatch_ = std::max<std::size_t>(1, config.getConsensusStreamMaxBatch(64));
+            linger_ = std::chrono::microseconds(config.getConsensusStreamLingerMicros(200));
+            queueLimit_ = std::max<std::size_t>(1, config.getConsensusStreamQueueLimit(4096));
+            sendDeadline_ = std::chrono::milliseconds(config.getGrpcSendDeadlineMillis(3000));
+            backoffMin_ = std::chrono::milliseconds(config.getGrpcReconnectBackoffMinMillis(100));
+            backoffMax_ = std::chrono::milliseconds(config.getGrpcReconnectBackoffMaxMillis(5000));
+            writer_ = std::thread([this] { run(); });
+        }
+
+        ~PeerStream() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+                if (context_) {
+                    context_->TryCancel();
+                }
+            }
+            wakeup_.notify_all();
+            space_.notify_all();
+            writer_.join();
+        }
+
+        PeerStream(const PeerStream&) = delete;
+        PeerStream& operator=(const PeerStream&) = delete;
+
+        bool send(const ConsensusEvent& event) {
+            ConsensusMessage message;
+            message.mutable_event()->CopyFrom(event);
+            return enqueue(std::move(message));
+        }
+
+        bool send(const ConsensusVote& vote) {
+            ConsensusMessage message;
+            message.mutable_vote()->CopyFrom(vote);
+            return enqueue(std::move(message));
+        }
+
+        bool send(const CommitCertificate& certificate) {
+            ConsensusMessage message;
+            message.mutable_commit()->CopyFrom(certificate);
+            return enqueue(std::move(message));
+        }
+
+    private:
+        bool enqueue(ConsensusMessage&& message) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (!space_.wait_for(lock, sendDeadline_, [this] {
+                        return stop_ || queue_.size() < queueLimit_;
+                    }) || stop_) {
+                    logger::warning("connection") << "stream to " << ip_ << " is still full";
+                    return false;
+                }
+                queue_.push_back(std::move(message));
+            }
+            wakeup_.notify_one();
+            return true;
+        }
+
+        void run() {
+            auto backoff = backoffMin_;
+            StatusResponse response;
+            std::unique_ptr<grpc::ClientWriter<ConsensusBatch>> stream;
+            while (true) {
+                ConsensusBatch batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wakeup_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    if (stop_) {
+                        break;
+                    }
+                    if (queue_.size() < maxBatch_) {
+                        wakeup_.wait_for(lock, linger_, [this] {
+                            return stop_ || queue_.size() >= maxBatch_;
+                        });
+                        if (stop_) {
+                            break;
+                        }
+                    }
+                    for (std::size_t n = 0; n < maxBatch_ && !queue_.empty(); n++) {
+                        batch.add_messages()->Swap(&queue_.front());
+                        queue_.pop_front();
+                    }
+
+                    if (!stream) {
+                        context_.reset(new ClientContext);
+                        stream = stub_->Stream(context_.get(), &response);
+                    }
+                }
+                space_.notify_all();
+
+                if (stream && stream->Write(batch)) {
+                    backoff = backoffMin_;
+                    continue;
+                }
+
+                logger::error("connection") << "stream to " << ip_ << " broken, reconnecting";
+                if (stream) {
+                    stream->Finish();
+                    stream.reset();
+                }
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                // put the batch back in front so per-peer order survives the reconnect
+                auto& messages = *batch.mutable_messages();
+                for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+                    queue_.emplace_front();
+                    queue_.front().Swap(&*it);
+                }
+                wakeup_.wait_for(lock, backoff, [this] { return stop_; });
+                backoff = std::min(backoff * 2, backoffMax_);
+            }
+
+            if (stream) {
+                stream->WritesDone();
+                stream->Finish();
+            }
+        }
+
+        Sumeragi::Stub* stub_;
+        const std::string ip_;
+        std::size_t maxBatch_;
+        std::chrono::microseconds linger_;
+        std::size_t queueLimit_;
+        std::chrono::milliseconds sendDeadline_;
+        std::chrono::milliseconds backoffMin_;
+        std::chrono::milliseconds backoffMax_;
+
+        std::mutex mutex_;
+        std::condition_variable wakeup_;
+        std::condition_variable space_;
+        std::deque<ConsensusMessage> queue_;
+        std::unique_ptr<ClientContext> context_;
+        bool stop_ = false;
+        std::thread writer_;
+    };
+
+    /**
+     * One long-lived channel per peer, with its stubs. gRPC reconnects a
+     * broken channel by itself, backing off between attempts, so a channel
+     * is only dropped when its peer leaves the peer set.
+     */
+    struct PeerChannel {
+        std::shared_ptr<Channel> channel;
+        std::unique_ptr<Sumeragi::Stub> sumeragi;
+        std::unique_ptr<Izanami::Stub> izanami;
+        // only with "consensus_transport": "stream", and only to other
+        // validators; declared last so it stops before the stub it writes
+        // through goes away
+        std::unique_ptr<PeerStream> stream;
     };
 
+    class ChannelPool {
+    public:
+        std::shared_ptr<PeerChannel> get(const std::string& ip) {
+            auto peers = ::peer::service::getPeerSet();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (peers->generation != peerSetGeneration_) {
+                for (auto it = channels_.begin(); it != channels_.end();) {
+                    // a peer that joined or left the validators gets a new
+                    // channel; whoever holds the old one can finish with it
+                    if (peers->findIp(it->first) == nullptr ||
+                        wantsStream(*peers, it->first) != (it->second->stream != nullptr)) {
+                        logger::info("connection") << "drop channel to " << it->first;
+                        it = channels_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                peerSetGeneration_ = peers->generation;
+            }
+
+            auto found = channels_.find(ip);
+            if (found != channels_.end()) {
+                return found->second;
+            }
+            auto peerChannel = std::make_shared<PeerChannel>();
+            peerChannel->channel = grpc::CreateCustomChannel(
+                ip + ":" + std::to_string(config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)),
+                grpc::InsecureChannelCredentials(),
+                arguments()
+            );
+            peerChannel->sumeragi = Sumeragi::NewStub(peerChannel->channel);
+            peerChannel->izanami = Izanami::NewStub(peerChannel->channel);
+            if (wantsStream(*peers, ip)) {
+                peerChannel->stream.reset(new PeerStream(peerChannel->sumeragi.get(), ip));
+            }
+            channels_.emplace(ip, peerChannel);
+            return peerChannel;
+        }
+
+    private:
+        // Messages to this peer itself, or to one only Izanami talks to,
+        // go over the unary rpcs.
+        static bool wantsStream(const ::peer::PeerSet& peers, const std::string& ip) {
+            return isStreamTransport() && ip != ::peer::myself::getIp() &&
+                   std::find(peers.ips.begin(), peers.ips.end(), ip) != peers.ips.end();
+        }
+
+        static grpc::ChannelArguments arguments() {
+            auto& config = config::IrohaConfigManager::getInstance();
+            grpc::ChannelArguments args;
+            args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, config.getGrpcKeepaliveMillis(10000));
+            args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, config.getGrpcKeepaliveTimeoutMillis(5000));
+            args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+            args.SetInt(GRPC_ARG_HTTP2_MAX_PINGS_WITHOUT_DATA, 0);
+            args.SetInt(GRPC_ARG_INITIAL_RECONNECT_BACKOFF_MS, config.getGrpcReconnectBackoffMinMillis(100));
+            args.SetInt(GRPC_ARG_MIN_RECONNECT_BACKOFF_MS, config.getGrpcReconnectBackoffMinMillis(100));
+            args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, config.getGrpcReconnectBackoffMaxMillis(5000));
+            return args;
+        }
+
+        std::mutex mutex_;
+        std::uint64_t peerSetGeneration_ = 0;
+        std::unordered_map<std::string, std::shared_ptr<PeerChannel>> channels_;
+    };
+
+    ChannelPool channelPool;
+
+    /**
+     * Verify::sendAll returns once a quorum has confirmed, but every peer
+     * still has to get the event, the proxy tail included. So its calls
+     * complete on this queue rather than on the caller's, and a single
+     * thread tallies them after the caller is gone.
+     */
+    namespace fanout {
+
+        // One sendAll; shared by the caller and its calls still in flight.
+        struct Round {
+            std::mutex mutex;
+            std::condition_variable progressed;
+            std::size_t pending = 0;
+            std::size_t confirmed = 0;
+            // what every confirmation has to sign, and who may sign it
+            std::string digest;
+            std::shared_ptr<const ::peer::PeerSet> peers;
+        };
+
+        struct Call {
+            std::string ip;
+            ClientContext context;
+            StatusResponse response;
+            Status status;
+            std::shared_ptr<PeerChannel> peerChannel;
+            std::unique_ptr<grpc::ClientAsyncResponseReader<StatusResponse>> reader;
+            std::shared_ptr<Round> round;
+        };
+
+        void drain(grpc::CompletionQueue* cq) {
+            void* tag;
+            bool ok;
+            while (cq->Next(&tag, &ok)) {
+                std::unique_ptr<Call> call(static_cast<Call*>(tag));
+                auto& round = *call->round;
+                const bool confirmed = call->status.ok()
+                    && confirms(call->response.confirm(), round.digest, *round.peers);
+                if (!call->status.ok()) {
+                    logger::error("connection") << call->ip << " " << call->status.error_code()
+                                                << ": " << call->status.error_message();
+                } else if (!confirmed) {
+                    logger::warning("connection") << call->ip << " sent an invalid confirmation";
+                }
+                std::lock_guard<std::mutex> lock(round.mutex);
+                round.pending--;
+                round.confirmed += confirmed;
+                round.progressed.notify_all();
+            }
+        }
+
+        // Never destroyed: calls may still be completing at exit.
+        grpc::CompletionQueue* queue() {
+            static auto cq = new grpc::CompletionQueue;
+            static std::once_flag started;
+            std::call_once(started, [] {
+                std::thread(drain, cq).detach();
+            });
+            return cq;
+        }
+
+    }
+
     namespace iroha {
         namespace Sumeragi {
             namespace Verify {
@@ -100,6 +423,22 @@ namespace connection {
                         >
                 > receivers;
             };
+            namespace Vote {
+                std::vector<
+                        std::function<void(
+                                const std::string& from,
+                                ConsensusVote& vote)
+                        >
+                > receivers;
+            };
+            namespace Commit {
+                std::vector<
+                        std::function<void(
+                                const std::string& from,
+                                CommitCertificate& certificate)
+                        >
+                > receivers;
+            };
             namespace Torii {
                 std::vector<
                         std::function<void(
@@ -107,6 +446,13 @@ namespace connection {
                                 Transaction& message
                         )>
                 > receivers;
+                std::vector<
+                        std::function<bool(
+                                const std::string& from,
+                                const Transaction& message,
+                                StatusResponse& response
+                        )>
+                > admissionChecks;
             }
         };
         namespace Izanami {
@@ -160,13 +506,13 @@ namespace connection {
 
     class SumeragiConnectionClient {
     public:
-        explicit SumeragiConnectionClient(std::shared_ptr<Channel> channel)
-                : stub_(Sumeragi::NewStub(channel)) {}
+        explicit SumeragiConnectionClient(std::shared_ptr<PeerChannel> peerChannel)
+                : peerChannel_(std::move(peerChannel)), stub_(peerChannel_->sumeragi.get()) {}
 
         Response Verify(const ConsensusEvent& consensusEvent) {
             StatusResponse response;
             logger::info("connection")  <<  "Operation";
-            logger::info("connection")  <<  "size: "    <<  consensusEvent.eventsignatures_size();
+            logger::info("connection")  <<  "size: "    <<  consensusEvent.signatureset().signatures_size();
             logger::info("connection")  <<  "name: "    <<  consensusEvent.transaction().asset().name();
 
             ClientContext context;
@@ -175,7 +521,9 @@ namespace connection {
 
             if (status.ok()) {
                 logger::info("connection")  << "response: " << response.value();
-                return {response.value(), valid(response.confirm()) ? RESPONSE_OK : RESPONSE_INVALID_SIG};
+                const bool confirmed = confirms(response.confirm(),
+                    ::sumeragi::makeEnvelope(consensusEvent).digest, *::peer::service::getPeerSet());
+                return {response.value(), confirmed ? RESPONSE_OK : RESPONSE_INVALID_SIG};
             } else {
                 logger::error("connection") << status.error_code() << ": " << status.error_message();
                 //std::cout << status.error_code() << ": " << status.error_message();
@@ -200,9 +548,58 @@ namespace connection {
             }
         }
 
+        bool Forward(const TransactionBatch& batch) {
+            StatusResponse response;
+            ClientContext context;
+            context.set_deadline(sendDeadline());
+            Status status = stub_->Forward(&context, batch, &response);
+            if (!status.ok()) {
+                logger::error("connection") << status.error_code() << ": " << status.error_message();
+                return false;
+            }
+            logger::info("connection") << "forwarded: " << response.message();
+            return true;
+        }
+
+        bool Vote(const ConsensusVote& vote) {
+            StatusResponse response;
+            ClientContext context;
+            context.set_deadline(sendDeadline());
+            Status status = stub_->Vote(&context, vote, &response);
+            if (!status.ok()) {
+                logger::error("connection") << status.error_code() << ": " << status.error_message();
+            }
+            return status.ok();
+        }
+
+        bool Commit(const CommitCertificate& certificate) {
+            StatusResponse response;
+            ClientContext context;
+            context.set_deadline(sendDeadline());
+            Status status = stub_->Commit(&context, certificate, &response);
+            if (!status.ok()) {
+                logger::error("connection") << status.error_code() << ": " << status.error_message();
+            }
+            return status.ok();
+        }
+
+        bool Fetch(std::uint64_t order, ConsensusEvent& event) {
+            CommitRequest request;
+            request.set_order(order);
+            ClientContext context;
+            context.set_deadline(sendDeadline());
+            Status status = stub_->Fetch(&context, request, &event);
+            if (!status.ok()) {
+                logger::error("connection") << status.error_code() << ": " << status.error_message();
+                return false;
+            }
+            return event.order() == order;
+        }
+
         bool Kagami() {
             StatusResponse response;
             ClientContext context;
+            context.set_deadline(sendDeadline());
             Query query;
             Status status = stub_->Kagami(&context, query, &response);
             if (status.ok()) {
@@ -215,13 +612,19 @@ namespace connection {
         }
 
     private:
-        std::unique_ptr<Sumeragi::Stub> stub_;
+        static std::chrono::system_clock::time_point sendDeadline() {
+            return std::chrono::system_clock::now() + std::chrono::milliseconds(
+                config::IrohaConfigManager::getInstance().getGrpcSendDeadlineMillis(3000));
+        }
+
+        std::shared_ptr<PeerChannel> peerChannel_;
+        Sumeragi::Stub* stub_;
     };
 
     class IzanamiConnectionClient {
     public:
-        explicit IzanamiConnectionClient(std::shared_ptr<Channel> channel)
-        : stub_(Izanami::NewStub(channel)) {}
+        explicit IzanamiConnectionClient(std::shared_ptr<PeerChannel> peerChannel)
+        : peerChannel_(std::move(peerChannel)), stub_(peerChannel_->izanami.get()) {}
 
         bool Izanagi(const TransactionResponse& txResponse) {
             StatusResponse response;
@@ -242,60 +645,279 @@ namespace connection {
         }
 
     private:
-        std::unique_ptr<Izanami::Stub> stub_;
+        std::shared_ptr<PeerChannel> peerChannel_;
+        Izanami::Stub* stub_;
     };
 
-    class SumeragiConnectionServiceImpl final : public Sumeragi::Service {
-    public:
+    // Request handlers shared by the synchronous and asynchronous servers.
+    namespace handler {
 
-        Status Verify(
-                ServerContext*          context,
-                const ConsensusEvent*   pevent,
-                StatusResponse*         response
-        ) override {
-            RecieverConfirmation confirm;
+        Status Verify(const ConsensusEvent& request, StatusResponse* response) {
             ConsensusEvent event;
-            event.CopyFrom(pevent->default_instance());
-            event.mutable_eventsignatures()->CopyFrom(pevent->eventsignatures());
-            event.mutable_transaction()->CopyFrom(pevent->transaction());
-            event.set_status(pevent->status());
-            logger::info("connection") << "size: " << event.eventsignatures_size();
+            event.CopyFrom(request);
+            logger::info("connection") << "size: " << event.signatureset().signatures_size();
             auto dummy = "";
             for (auto& f: iroha::Sumeragi::Verify::receivers){
                 f(dummy, event);
             }
-            confirm = sign(pevent->transaction().hash());
             response->set_value("OK");
-            response->mutable_confirm()->CopyFrom(confirm);
+            // the block digest every validator signs, never a field of the event
+            response->mutable_confirm()->CopyFrom(sign(::sumeragi::makeEnvelope(request).digest));
             return Status::OK;
         }
 
-        Status Torii(
-            ServerContext*      context,
-            const Transaction*  transaction,
-            StatusResponse*     response
-        ) override {
-            RecieverConfirmation confirm;
+        Status Torii(const Transaction& transaction, StatusResponse* response) {
             auto dummy = "";
+            for (auto& check: iroha::Sumeragi::Torii::admissionChecks){
+                if (!check(dummy, transaction, *response)) {
+                    response->set_value("REJECTED");
+                    return Status::OK;
+                }
+            }
             Transaction tx;
-            tx.CopyFrom(*transaction);
+            tx.CopyFrom(transaction);
             for (auto& f: iroha::Sumeragi::Torii::receivers){
                 f(dummy, tx);
             }
-            confirm = sign(transaction->hash());
             response->set_value("OK");
-            response->mutable_confirm()->CopyFrom(confirm);
+            response->mutable_confirm()->CopyFrom(sign(transaction.hash()));
             return Status::OK;
         }
 
+        // Every transaction goes through Torii on its own; a rejection
+        // only lowers the count in the reply.
+        Status Forward(const TransactionBatch& batch, StatusResponse* response) {
+            int accepted = 0;
+            for (auto& transaction: batch.transactions()) {
+                StatusResponse reply;
+                Torii(transaction, &reply);
+                if (reply.value() == "OK") {
+                    accepted++;
+                }
+            }
+            response->set_value("OK");
+            response->set_message("accepted " + std::to_string(accepted) + " of " +
+                                  std::to_string(batch.transactions_size()));
+            return Status::OK;
+        }
+
+        // Straight from the ledger; the one asking checks the signatures.
+        Status Fetch(const CommitRequest& request, ConsensusEvent* response) {
+            if (!merkle_transaction_repository::findCommitted(request.order(), *response)) {
+                response->Clear();
+            }
+            return Status::OK;
+        }
+
+        // Votes and certificates are checked by sumeragi, so nothing is
+        // signed back.
+        Status Vote(const ConsensusVote& request, StatusResponse* response) {
+            ConsensusVote vote;
+            vote.CopyFrom(request);
+            auto dummy = "";
+            for (auto& f: iroha::Sumeragi::Vote::receivers){
+                f(dummy, vote);
+            }
+            response->set_value("OK");
+            return Status::OK;
+        }
+
+        Status Commit(const CommitCertificate& request, StatusResponse* response) {
+            CommitCertificate certificate;
+            certificate.CopyFrom(request);
+            auto dummy = "";
+            for (auto& f: iroha::Sumeragi::Commit::receivers){
+                f(dummy, certificate);
+            }
+            response->set_value("OK");
+            return Status::OK;
+        }
+
+        Status Kagami(const Query& query, StatusResponse* response) {
+            response->set_message("OK, no problem!");
+            response->set_value("Alive");
+            response->set_timestamp(datetime::unixtime());
+            return Status::OK;
+        }
+
+        Status Izanagi(const TransactionResponse& txResponse, StatusResponse* response) {
+            TransactionResponse txres;
+            txres.CopyFrom(txResponse);
+            logger::info("connection") << "size: " << txres.transaction_size();
+            auto dummy = "";
+            for (auto& f: iroha::Izanami::Izanagi::receivers){
+                f(dummy, txres);
+            }
+            response->set_message("OK, no problem!");
+            response->set_value("OK");
+            response->set_timestamp(datetime::unixtime());
+            return Status::OK;
+        }
+
+        // One page of the ledger; the query may carry "limit" and the
+        // "resumeToken" of the previous page.
+        Status TransactionFind(const Query& query, TransactionResponse* response) {
+            static const std::size_t maxLimit =
+                config::IrohaConfigManager::getInstance().getTransactionPageLimit(1000);
+            auto limit = maxLimit;
+            std::string resumeToken;
+            const auto limitValue = query.value().find("limit");
+            if (limitValue != query.value().end() && limitValue->second.valueint() > 0) {
+                limit = std::min<std::size_t>(limit, limitValue->second.valueint());
+            }
+            const auto tokenValue = query.value().find("resumeToken");
+            if (tokenValue != query.value().end()) {
+                resumeToken = tokenValue->second.valuestring();
+            }
+            repository::transaction::Page page;
+            try {
+                page = repository::transaction::findPage(resumeToken, limit);
+            } catch (const std::invalid_argument& e) {
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, e.what());
+            }
+            for (auto&& tx : page.transactions) {
+                *response->add_transaction() = std::move(tx);
+            }
+            response->set_resumetoken(page.resumeToken);
+            response->set_message("OK");
+            return Status::OK;
+        }
+
+        Status TransactionFetch(const Query& query, TransactionResponse* response) {
+            Query q;
+            q.CopyFrom(query);
+            auto dummy = "";
+            for (auto& f: iroha::TransactionRepository::find::receivers){
+                f(dummy, q);
+            }
+            response->set_message("OK");
+            return Status::OK;
+        }
+
+        Status AssetFind(const Query& query, AssetResponse* response) {
+            std::string name = "default";
+            logger::info("connection") << "AssetRepositoryService: " << query.DebugString();
+
+            if(query.value().find("name")!=query.value().end()){
+                name = query.value().at("name").valuestring();
+            }
+
+            auto sender = query.senderpubkey();
+            if(query.type() == "asset"){
+                response->mutable_asset()->CopyFrom(repository::asset::find(sender, name));
+                logger::info("connection") << "-AssetRepositoryService: " << response->asset().DebugString();
+            }else if(query.type() == "account"){
+                response->mutable_account()->CopyFrom(repository::account::find(sender));
+                logger::info("connection") << "-AccountRepositoryService: " << response->account().DebugString();
+            }else if(query.type() == "assets"){
+                // the account and all of its assets in one round trip
+                response->mutable_account()->CopyFrom(repository::account::find(sender));
+                std::vector<std::pair<std::string, std::string>> keys;
+                for (auto&& assetName : response->account().assets()) {
+                    keys.emplace_back(sender, assetName);
+                }
+                for (auto&& asset : repository::asset::findMany(keys)) {
+                    *response->add_assets() = std::move(asset);
+                }
+                logger::info("connection") << "-AssetsRepositoryService: " << response->assets_size() << " assets";
+            }
+            response->set_message("OK");
+            return Status::OK;
+        }
+    };
+
+    class SumeragiConnectionServiceImpl : public Sumeragi::Service {
+    public:
+
+        Status Verify(
+                ServerContext*          context,
+                const ConsensusEvent*   pevent,
+                StatusResponse*         response
+        ) override {
+            return handler::Verify(*pevent, response);
+        }
+
+        Status Torii(
+            ServerContext*      context,
+            const Transaction*  transaction,
+            StatusResponse*     response
+        ) override {
+            return handler::Torii(*transaction, response);
+        }
+
+        Status Forward(
+            ServerContext*              context,
+            const TransactionBatch*     batch,
+            StatusResponse*             response
+        ) override {
+            return handler::Forward(*batch, response);
+        }
+
         Status Kagami(
             ServerContext*      context,
             const Query*          query,
             StatusResponse*     response
         ) override {
-            response->set_message("OK, no problem!");
-            response->set_value("Alive");
-            response->set_timestamp(datetime::unixtime());
+            return handler::Kagami(*query, response);
+        }
+
+        Status Vote(
+            ServerContext*          context,
+            const ConsensusVote*    vote,
+            StatusResponse*         response
+        ) override {
+            return handler::Vote(*vote, response);
+        }
+
+        Status Commit(
+            ServerContext*              context,
+            const CommitCertificate*    certificate,
+            StatusResponse*             response
+        ) override {
+            return handler::Commit(*certificate, response);
+        }
+
+        Status Fetch(
+            ServerContext*          context,
+            const CommitRequest*    request,
+            ConsensusEvent*         response
+        ) override {
+            return handler::Fetch(*request, response);
+        }
+
+        // Batches from one peer are handled in order on this thread. Nothing
+        // is written back; replies travel on the reverse stream as events.
+        Status Stream(
+            ServerContext*      context,
+            ServerReader<ConsensusBatch>* reader,
+            StatusResponse*     response
+        ) override {
+            ConsensusBatch batch;
+            while (reader->Read(&batch)) {
+                auto dummy = "";
+                for (auto& message : *batch.mutable_messages()) {
+                    switch (message.kind_case()) {
+                    case ConsensusMessage::kEvent:
+                        for (auto& f: iroha::Sumeragi::Verify::receivers){
+                            f(dummy, *message.mutable_event());
+                        }
+                        break;
+                    case ConsensusMessage::kVote:
+                        for (auto& f: iroha::Sumeragi::Vote::receivers){
+                            f(dummy, *message.mutable_vote());
+                        }
+                        break;
+                    case ConsensusMessage::kCommit:
+                        for (auto& f: iroha::Sumeragi::Commit::receivers){
+                            f(dummy, *message.mutable_commit());
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            response->set_value("OK");
             return Status::OK;
         }
 
@@ -309,24 +931,11 @@ namespace connection {
                 const TransactionResponse*   txResponse,
                 StatusResponse*         response
         ) override {
-            TransactionResponse txres;
-            txres.CopyFrom(txResponse->default_instance());
-            txres.set_message(txResponse->message());
-            txres.set_code(txResponse->code());
-            txres.mutable_transaction()->CopyFrom(txResponse->transaction());
-            logger::info("connection") << "size: " << txres.transaction_size();
-            auto dummy = "";
-            for (auto& f: iroha::Izanami::Izanagi::receivers){
-                f(dummy, txres);
-            }
-            response->set_message("OK, no problem!");
-            response->set_value("OK");
-            response->set_timestamp(datetime::unixtime());
-            return Status::OK;
+            return handler::Izanagi(*txResponse, response);
         }
     };
 
-    class TransactionRepositoryServiceImpl final : public TransactionRepository::Service {
+    class TransactionRepositoryServiceImpl : public TransactionRepository::Service {
       public:
 
         Status find(
@@ -334,15 +943,7 @@ namespace connection {
             const Query*              query,
             TransactionResponse*   response
         ) override {
-            Query q;
-            q.CopyFrom(*query);
-            // ToDo use query
-            auto transactions = repository::transaction::findAll();
-            for(auto tx: transactions){
-                response->add_transaction()->CopyFrom(tx);
-            }
-            response->set_message("OK");
-            return Status::OK;
+            return handler::TransactionFind(*query, response);
         }
 
         Status fetch(
@@ -350,14 +951,7 @@ namespace connection {
             const Query*              query,
             TransactionResponse*   response
         ) override {
-            Query q;
-            q.CopyFrom(*query);
-            auto dummy = "";
-            for (auto& f: iroha::TransactionRepository::find::receivers){
-                f(dummy, q);
-            }
-            response->set_message("OK");
-            return Status::OK;
+            return handler::TransactionFetch(*query, response);
         }
 
         Status fetchStream(
@@ -383,27 +977,148 @@ namespace connection {
             const Query*              query,
             AssetResponse*         response
         ) override {
-            std::string name = "default";
-            Query q;
-            q.CopyFrom(*query);
-            logger::info("connection") << "AssetRepositoryService: " << q.DebugString();
+            return handler::AssetFind(*query, response);
+        }
+    };
+
+    /**
+     * Async server mode: completion-queue threads only accept calls and
+     * write replies; handlers run on a worker pool, so a slow handler
+     * never holds up a gRPC thread.
+     */
+    namespace async {
+
+        class Call {
+        public:
+            virtual ~Call() {}
+            virtual void proceed(bool ok) = 0;
+        };
 
-            if(q.value().find("name")!=q.value().end()){
-                name = q.value().at("name").valuestring();
+        ThreadPool& workers() {
+            static ThreadPool pool(ThreadPoolOptions{
+                .threads_count = [] {
+                    auto configured = config::IrohaConfigManager::getInstance().getGrpcServerWorkers(0);
+                    return configured > 0 ? configured
+                        : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+                }(),
+                .worker_queue_size =
+                    config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
+            });
+            return pool;
+        }
+
+        template <typename Service, typename Request, typename Response>
+        class UnaryCall : public Call {
+        public:
+            using RequestMethod = void (Service::*)(
+                ServerContext*, Request*, grpc::ServerAsyncResponseWriter<Response>*,
+                grpc::CompletionQueue*, grpc::ServerCompletionQueue*, void*);
+            using Handler = Status (*)(const Request&, Response*);
+
+            // Waits for the next call to method on cq.
+            static void listen(Service* service, RequestMethod method,
+                               Handler handler, grpc::ServerCompletionQueue* cq) {
+                new UnaryCall(service, method, handler, cq);
             }
 
-            auto sender = q.senderpubkey();
-            if(q.type() == "asset"){
-                response->mutable_asset()->CopyFrom(repository::asset::find(sender, name));
-                logger::info("connection") << "-AssetRepositoryService: " << response->asset().DebugString();
-            }else if(q.type() == "account"){
-                response->mutable_account()->CopyFrom(repository::account::find(sender));
-                logger::info("connection") << "-AccountRepositoryService: " << response->account().DebugString();
+            void proceed(bool ok) override {
+                if (finished_ || !ok) {
+                    // replied, or the server is shutting down
+                    delete this;
+                    return;
+                }
+                listen(service_, method_, handler_, cq_);
+                std::function<void()> task = [this] {
+                    auto status = handler_(request_, &response_);
+                    finished_ = true;
+                    writer_.Finish(response_, status, this);
+                };
+                try {
+                    workers().process(std::move(task));
+                } catch (const std::exception& e) {
+                    // a throw here would end the poller thread; turn the
+                    // caller away instead, as a full pool does elsewhere
+                    logger::warning("connection") << "worker pool is full: " << e.what();
+                    finished_ = true;
+                    writer_.Finish(response_,
+                        Status(grpc::StatusCode::RESOURCE_EXHAUSTED, e.what()), this);
+                }
             }
-            response->set_message("OK");
-            return Status::OK;
+
+        private:
+            UnaryCall(Service* service, RequestMethod method,
+                      Handler handler, grpc::ServerCompletionQueue* cq)
+                : service_(service), method_(method), handler_(handler),
+                  cq_(cq), writer_(&context_) {
+                (service_->*method_)(&context_, &request_, &writer_, cq_, cq_, this);
+            }
+
+            Service* service_;
+            RequestMethod method_;
+            Handler handler_;
+            grpc::ServerCompletionQueue* cq_;
+            ServerContext context_;
+            Request request_;
+            Response response_;
+            grpc::ServerAsyncResponseWriter<Response> writer_;
+            bool finished_ = false;
+        };
+
+        template <typename Service, typename Request, typename Response>
+        void listen(Service* service,
+                    typename UnaryCall<Service, Request, Response>::RequestMethod method,
+                    Status (*handler)(const Request&, Response*),
+                    grpc::ServerCompletionQueue* cq) {
+            UnaryCall<Service, Request, Response>::listen(service, method, handler, cq);
         }
-    };
+
+        // Stream is a client stream and stays synchronous
+        Sumeragi::WithAsyncMethod_Verify<
+            Sumeragi::WithAsyncMethod_Torii<
+                Sumeragi::WithAsyncMethod_Forward<
+                    Sumeragi::WithAsyncMethod_Kagami<
+                        Sumeragi::WithAsyncMethod_Vote<
+                            Sumeragi::WithAsyncMethod_Commit<
+                                Sumeragi::WithAsyncMethod_Fetch<SumeragiConnectionServiceImpl>
+                            >
+                        >
+                    >
+                >
+            >
+        > sumeragi;
+        Izanami::AsyncService izanami;
+        AssetRepository::AsyncService assetRepository;
+        // fetchStream is a client stream and stays synchronous
+        TransactionRepository::WithAsyncMethod_find<
+            TransactionRepository::WithAsyncMethod_fetch<TransactionRepositoryServiceImpl>
+        > transactionRepository;
+
+        std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> queues;
+
+        void listenAll(grpc::ServerCompletionQueue* cq) {
+            listen(&sumeragi, &decltype(sumeragi)::RequestVerify, handler::Verify, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestTorii, handler::Torii, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestForward, handler::Forward, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestKagami, handler::Kagami, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestVote, handler::Vote, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestCommit, handler::Commit, cq);
+            listen(&sumeragi, &decltype(sumeragi)::RequestFetch, handler::Fetch, cq);
+            listen(&izanami, &Izanami::AsyncService::RequestIzanagi, handler::Izanagi, cq);
+            listen(&assetRepository, &AssetRepository::AsyncService::Requestfind, handler::AssetFind, cq);
+            listen(&transactionRepository, &decltype(transactionRepository)::Requestfind,
+                   handler::TransactionFind, cq);
+            listen(&transactionRepository, &decltype(transactionRepository)::Requestfetch,
+                   handler::TransactionFetch, cq);
+        }
+
+        void poll(grpc::ServerCompletionQueue* cq) {
+            void* tag;
+            bool ok;
+            while (cq->Next(&tag, &ok)) {
+                static_cast<Call*>(tag)->proceed(ok);
+            }
+        }
+    }
 
     namespace iroha {
 
@@ -426,14 +1141,12 @@ namespace connection {
                     const std::string &ip,
                     const ConsensusEvent &event
                 ) {
-                    auto receiver_ips = ::peer::service::getIpList();
-                    if (find(receiver_ips.begin(), receiver_ips.end(), ip) != receiver_ips.end()) {
-                        SumeragiConnectionClient client(
-                            grpc::CreateChannel(
-                                ip + ":" + std::to_string(config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)),
-                                grpc::InsecureChannelCredentials()
-                            )
-                        );
+                    if (::peer::service::getPeerSet()->isActiveIp(ip)) {
+                        auto peerChannel = channelPool.get(ip);
+                        if (peerChannel->stream && peerChannel->stream->send(event)) {
+                            return true;
+                        }
+                        SumeragiConnectionClient client(std::move(peerChannel));
                         // TODO return tx validity
                         auto reply = client.Verify(event);
                         return true;
@@ -445,13 +1158,124 @@ namespace connection {
                 bool sendAll(
                     const ConsensusEvent &event
                 ) {
-                    auto receiver_ips = ::peer::service::getIpList();
-                    for (auto &ip : receiver_ips) {
-                        send(ip, event);
+                    sendAll(event, ::peer::service::getPeerSet()->ips.size());
+                    return true;
+                }
+
+                std::size_t sendAll(
+                    const ConsensusEvent &event,
+                    std::size_t quorum
+                ) {
+                    auto peers = ::peer::service::getPeerSet();
+                    if (isStreamTransport()) {
+                        // streams carry no confirmation; count the peers it was queued for
+                        std::size_t queued = 0;
+                        for (auto &ip : peers->ips) {
+                            auto peerChannel = channelPool.get(ip);
+                            if (peerChannel->stream && peerChannel->stream->send(event)) {
+                                queued++;
+                            } else if (SumeragiConnectionClient(std::move(peerChannel)).Verify(event).second
+                                       == RESPONSE_OK) {
+                                queued++;
+                            }
+                        }
+                        return queued;
+                    }
+
+                    const auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(
+                        config::IrohaConfigManager::getInstance().getGrpcSendDeadlineMillis(3000));
+
+                    auto round = std::make_shared<fanout::Round>();
+                    round->pending = peers->ips.size();
+                    round->digest = ::sumeragi::makeEnvelope(event).digest;
+                    round->peers = peers;
+                    for (auto &ip : peers->ips) {
+                        auto call = new fanout::Call;
+                        call->ip = ip;
+                        call->context.set_deadline(deadline);
+                        call->peerChannel = channelPool.get(ip);
+                        call->round = round;
+                        call->reader = call->peerChannel->sumeragi->AsyncVerify(
+                            &call->context, event, fanout::queue());
+                        call->reader->Finish(&call->response, &call->status, call);
+                    }
+
+                    // the calls still pending run on to their deadline
+                    std::unique_lock<std::mutex> lock(round->mutex);
+                    round->progressed.wait(lock, [&] {
+                        return round->pending == 0 || round->confirmed >= quorum;
+                    });
+                    return round->confirmed;
+                }
+
+            }
+
+            namespace Vote {
+
+                bool receive(
+                    const std::function<void(
+                        const std::string&,
+                        ConsensusVote&)>& callback
+                ) {
+                    receivers.push_back(callback);
+                    return true;
+                }
+
+                bool send(
+                    const std::string &ip,
+                    const ConsensusVote &vote
+                ) {
+                    if (!::peer::service::getPeerSet()->isActiveIp(ip)) {
+                        return false;
                     }
+                    auto peerChannel = channelPool.get(ip);
+                    if (peerChannel->stream && peerChannel->stream->send(vote)) {
+                        return true;
+                    }
+                    return SumeragiConnectionClient(std::move(peerChannel)).Vote(vote);
+                }
+
+            }
+
+            namespace Commit {
+
+                bool receive(
+                    const std::function<void(
+                        const std::string&,
+                        CommitCertificate&)>& callback
+                ) {
+                    receivers.push_back(callback);
                     return true;
                 }
 
+                std::size_t sendAll(
+                    const CommitCertificate &certificate
+                ) {
+                    auto peers = ::peer::service::getPeerSet();
+                    std::size_t delivered = 0;
+                    for (auto &ip : peers->ips) {
+                        if (ip == ::peer::myself::getIp()) {
+                            continue;
+                        }
+                        auto peerChannel = channelPool.get(ip);
+                        if (peerChannel->stream && peerChannel->stream->send(certificate)) {
+                            delivered++;
+                        } else {
+                            delivered += SumeragiConnectionClient(std::move(peerChannel)).Commit(certificate);
+                        }
+                    }
+                    return delivered;
+                }
+
+                bool fetch(
+                    const std::string &ip,
+                    std::uint64_t order,
+                    ConsensusEvent &event
+                ) {
+                    SumeragiConnectionClient client(channelPool.get(ip));
+                    return client.Fetch(order, event);
+                }
+
             }
 
             namespace Torii {
@@ -465,6 +1289,16 @@ namespace connection {
                     return true;
                 }
 
+                bool admit(
+                    const std::function<bool(
+                    const std::string &,
+                    const Transaction&,
+                    StatusResponse&)
+                > &check){
+                    admissionChecks.push_back(check);
+                    return true;
+                }
+
             }
 
         }
@@ -477,35 +1311,37 @@ namespace connection {
                         const std::string &ip,
                         const Transaction &transaction
                 ) {
-                    auto receiver_ips = ::peer::service::getIpList();
-                    if (find(receiver_ips.begin(), receiver_ips.end(), ip) != receiver_ips.end()) {
-                        SumeragiConnectionClient client(
-                                grpc::CreateChannel(
-                                        ip + ":" + std::to_string(
-                                                config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)),
-                                        grpc::InsecureChannelCredentials()
-                                )
-                        );
+                    if (::peer::service::getPeerSet()->isActiveIp(ip)) {
+                        SumeragiConnectionClient client(channelPool.get(ip));
                         // TODO return tx validity
                         auto reply = client.Torii(transaction);
+                        if (reply.first == "REJECTED") {
+                            logger::warning("connection") << ip << " rejected a forwarded transaction";
+                        }
                         return true;
                     } else {
                         return false;
                     }
                 }
 
+                bool forward(
+                        const std::string &ip,
+                        const TransactionBatch &batch
+                ) {
+                    if (::peer::service::getPeerSet()->isActiveIp(ip)) {
+                        SumeragiConnectionClient client(channelPool.get(ip));
+                        return client.Forward(batch);
+                    } else {
+                        logger::error("Connection_with_grpc") << "Unexpected ip: " << ip;
+                        return false;
+                    }
+                }
+
                 bool ping(
                         const std::string &ip
                 ) {
-                    auto receiver_ips = ::peer::service::getIpList();
-                    if (find(receiver_ips.begin(), receiver_ips.end(), ip) != receiver_ips.end()) {
-                        SumeragiConnectionClient client(
-                                grpc::CreateChannel(
-                                        ip + ":" + std::to_string(
-                                                config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)),
-                                        grpc::InsecureChannelCredentials()
-                                )
-                        );
+                    if (::peer::service::getPeerSet()->isActiveIp(ip)) {
+                        SumeragiConnectionClient client(channelPool.get(ip));
                         return client.Kagami();
                     } else {
                         logger::error("Connection_with_grpc") << "Unexpected ip: " << ip;
@@ -519,13 +1355,7 @@ namespace connection {
                         const std::string& ip,
                         const TransactionResponse &txResponse
                 ) {
-                    IzanamiConnectionClient client(
-                            grpc::CreateChannel(
-                                    ip + ":" + std::to_string(
-                                            config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)),
-                                    grpc::InsecureChannelCredentials()
-                            )
-                    );
+                    IzanamiConnectionClient client(channelPool.get(ip));
                     return client.Izanagi(txResponse);
                 }
             }
@@ -601,18 +1431,56 @@ namespace connection {
 
     ServerBuilder builder;
 
+    bool isAsyncServer() {
+        return config::IrohaConfigManager::getInstance().getGrpcServerMode("sync") == "async";
+    }
+
     void initialize_peer() {
         std::string server_address("0.0.0.0:" + std::to_string(config::IrohaConfigManager::getInstance().getGrpcPortNumber(50051)));
         builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-        builder.RegisterService(&iroha::Sumeragi::service);
-        builder.RegisterService(&iroha::Izanami::service);
-        builder.RegisterService(&iroha::TransactionRepository::service);
-        builder.RegisterService(&iroha::AssetRepository::find::service);
+        if (isAsyncServer()) {
+            builder.RegisterService(&async::sumeragi);
+            builder.RegisterService(&async::izanami);
+            builder.RegisterService(&async::transactionRepository);
+            builder.RegisterService(&async::assetRepository);
+            auto queues = std::max<std::size_t>(1,
+                config::IrohaConfigManager::getInstance().getGrpcServerCompletionQueues(2));
+            for (std::size_t i = 0; i < queues; i++) {
+                async::queues.push_back(builder.AddCompletionQueue());
+            }
+        } else {
+            builder.RegisterService(&iroha::Sumeragi::service);
+            builder.RegisterService(&iroha::Izanami::service);
+            builder.RegisterService(&iroha::TransactionRepository::service);
+            builder.RegisterService(&iroha::AssetRepository::find::service);
+        }
     }
 
     int run() {
         std::unique_ptr<Server> server(builder.BuildAndStart());
+        std::vector<std::thread> pollers;
+        if (isAsyncServer()) {
+            auto threadsPerQueue = std::max<std::size_t>(1,
+                config::IrohaConfigManager::getInstance().getGrpcServerThreadsPerQueue(2));
+            logger::info("connection") << "async server with " << async::queues.size()
+                                       << " completion queues, " << threadsPerQueue << " threads each";
+            for (auto &cq : async::queues) {
+                // one outstanding call per method and polling thread
+                for (std::size_t i = 0; i < threadsPerQueue; i++) {
+                    async::listenAll(cq.get());
+                }
+                for (std::size_t i = 0; i < threadsPerQueue; i++) {
+                    pollers.emplace_back(async::poll, cq.get());
+                }
+            }
+        }
         server->Wait();
+        for (auto &cq : async::queues) {
+            cq->Shutdown();
+        }
+        for (auto &poller : pollers) {
+            poller.join();
+        }
         return 0;
     }
     void finish(){
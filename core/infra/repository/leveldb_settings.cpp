@@ -0,0 +1,55 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <infra/config/iroha_config_with_json.hpp>
+#include <util/logger.hpp>
+
+#include "leveldb_settings.hpp"
+
+namespace repository {
+
+  namespace world_state_repository {
+
+      LeveldbSettings leveldbProfile(const std::string &name) {
+          if (name == "low-memory") {
+              return LeveldbSettings{4 << 20, 10, 2 << 20, 200, 4 << 10, true};
+          }
+          if (name == "high-throughput") {
+              return LeveldbSettings{256 << 20, 10, 64 << 20, 10000, 16 << 10, true};
+          }
+          if (name != "default") {
+              logger::warning("WorldStateRepositoryWithLeveldb") << "unknown leveldb_profile " << name << ", using default";
+          }
+          return LeveldbSettings{8 << 20, 10, 4 << 20, 1000, 4 << 10, true};
+      }
+
+      LeveldbSettings leveldbSettings() {
+          auto &config = config::IrohaConfigManager::getInstance();
+          const auto preset = leveldbProfile(config.getLeveldbProfile("default"));
+
+          LeveldbSettings settings;
+          settings.blockCacheBytes = config.getLeveldbBlockCacheBytes(preset.blockCacheBytes);
+          settings.bloomBitsPerKey = config.getLeveldbBloomBitsPerKey(preset.bloomBitsPerKey);
+          settings.writeBufferBytes = config.getLeveldbWriteBufferBytes(preset.writeBufferBytes);
+          settings.maxOpenFiles = config.getLeveldbMaxOpenFiles(preset.maxOpenFiles);
+          settings.blockSize = config.getLeveldbBlockSize(preset.blockSize);
+          settings.compression = config.getLeveldbCompression(preset.compression ? "snappy" : "none") != "none";
+          return settings;
+      }
+
+  };
+
+}; // namespace repository
@@ -0,0 +1,51 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+http://soramitsu.co.jp
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_INFRA_REPOSITORY_LEVELDB_SETTINGS_HPP_
+#define CORE_INFRA_REPOSITORY_LEVELDB_SETTINGS_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace repository {
+
+  namespace world_state_repository {
+
+      // What the world state database is opened with.
+      struct LeveldbSettings {
+          std::size_t blockCacheBytes;
+          std::size_t bloomBitsPerKey; // 0: no filter
+          std::size_t writeBufferBytes;
+          std::size_t maxOpenFiles;
+          std::size_t blockSize;
+          bool compression;
+      };
+
+      // A leveldb_profile preset. low-memory suits small peers,
+      // high-throughput trades RAM for fewer compactions and table reads;
+      // an unknown name gets default.
+      LeveldbSettings leveldbProfile(const std::string &name);
+
+      // The preset leveldb_profile names, each field overridden by its own
+      // leveldb_* key.
+      LeveldbSettings leveldbSettings();
+
+  };
+
+}; // namespace repository
+
+#endif // CORE_INFRA_REPOSITORY_LEVELDB_SETTINGS_HPP_
@@ -14,14 +14,26 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
 
+#include <thread_pool.hpp>
+
 #include <infra/config/iroha_config_with_json.hpp>
 #include <repository/world_state_repository.hpp>
+
+#include "leveldb_settings.hpp"
 #include <util/exception.hpp>
 #include <util/logger.hpp>
+#include <util/lru_cache.hpp>
 
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 
 // +------------------------------------------------+
@@ -44,6 +56,8 @@ namespace repository {
 
               static leveldb::DB* db = nullptr;
 
+              thread_local Scope* scope = nullptr;
+
               bool loggerStatus(leveldb::Status const status) {
                   if (!status.ok()) {
                       logger::info("WorldStateRepositoryWithLeveldb") << status.ToString();
@@ -52,17 +66,290 @@ namespace repository {
                   return true;
               }
 
-              void loadDb() {
+              // Owned here, since db only borrows them. Made on the first
+              // open and reused if it fails, so loadDb() can be retried; freed
+              // in finish().
+              static leveldb::Cache* blockCache = nullptr;
+              static const leveldb::FilterPolicy* filterPolicy = nullptr;
+
+              leveldb::Options options() {
+                  const auto settings = leveldbSettings();
+
                   leveldb::Options options;
                   options.error_if_exists = false;
                   options.create_if_missing = true;
+                  options.write_buffer_size = settings.writeBufferBytes;
+                  options.max_open_files = static_cast<int>(settings.maxOpenFiles);
+                  options.block_size = settings.blockSize;
+                  options.compression = settings.compression
+                      ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+
+                  if (nullptr == blockCache) {
+                      blockCache = leveldb::NewLRUCache(settings.blockCacheBytes);
+                  }
+                  options.block_cache = blockCache;
+                  if (settings.bloomBitsPerKey > 0) {
+                      // lets a Get of an absent key skip reading the table
+                      if (nullptr == filterPolicy) {
+                          filterPolicy = leveldb::NewBloomFilterPolicy(static_cast<int>(settings.bloomBitsPerKey));
+                      }
+                      options.filter_policy = filterPolicy;
+                  }
 
+                  logger::info("WorldStateRepositoryWithLeveldb")
+                      << "block cache " << settings.blockCacheBytes
+                      << ", bloom bits " << settings.bloomBitsPerKey
+                      << ", write buffer " << options.write_buffer_size
+                      << ", max open files " << options.max_open_files;
+                  return options;
+              }
+
+              void loadDb() {
                   logger::info("WorldStateRepositoryWithLeveldb") << "LoadDB";
-                  loggerStatus(leveldb::DB::Open(options,
+                  loggerStatus(leveldb::DB::Open(options(),
                         config::IrohaConfigManager::getInstance().getDatabasePath("/tmp/iroha_ledger"),
                         &db
                   ));
               }
+
+              // Values as last read or written; a miss costs a Get.
+              lru::ShardedCache& cache() {
+                  static lru::ShardedCache instance(
+                      config::IrohaConfigManager::getInstance().getWorldStateCacheBytes(64 << 20),
+                      config::IrohaConfigManager::getInstance().getWorldStateCacheShards(16)
+                  );
+                  return instance;
+              }
+
+              // The stored value, empty if the key is absent.
+              std::string read(const std::string &key) {
+                  std::string value;
+                  if (cache().get(key, value)) {
+                      return value;
+                  }
+                  if (nullptr == db) {
+                      loadDb();
+                  }
+                  if (nullptr == db) {
+                      logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+                      return "";
+                  }
+                  const auto generation = cache().generation(key);
+                  auto status = db->Get(leveldb::ReadOptions(), key, &value);
+                  if (!status.ok() && !status.IsNotFound()) {
+                      loggerStatus(status);
+                      return "";
+                  }
+                  cache().fill(key, value, generation);
+                  return value;
+              }
+      }
+
+      namespace detail {
+
+              // Next() calls tried before falling back to a Seek
+              constexpr int MAX_STEPS = 4;
+
+              ThreadPool &readers() {
+                  static ThreadPool pool(ThreadPoolOptions{
+                      .threads_count = std::max<std::size_t>(1, std::thread::hardware_concurrency()),
+                      .worker_queue_size =
+                          config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
+                  });
+                  return pool;
+              }
+
+              // Reads keys[first, last), sorted, from snapshot into values.
+              void readSorted(
+                  const std::vector<std::string> &keys,
+                  std::size_t first, std::size_t last,
+                  const leveldb::Snapshot *snapshot,
+                  std::vector<std::string> &values
+              ) {
+                  leveldb::ReadOptions options;
+                  options.snapshot = snapshot;
+                  std::unique_ptr<leveldb::Iterator> it(db->NewIterator(options));
+                  bool positioned = false;
+                  for (auto i = first; i < last; i++) {
+                      const leveldb::Slice key(keys[i]);
+                      int steps = 0;
+                      while (positioned && it->Valid() && it->key().compare(key) < 0 && steps < MAX_STEPS) {
+                          it->Next();
+                          steps++;
+                      }
+                      if (!positioned || !it->Valid() || it->key().compare(key) < 0) {
+                          it->Seek(key);
+                          positioned = true;
+                      }
+                      if (it->Valid() && it->key() == key) {
+                          values[i] = it->value().ToString();
+                      }
+                  }
+                  loggerStatus(it->status());
+              }
+      }
+
+      std::vector<optional<std::string>> multiGet(const std::vector<std::string> &keys) {
+          std::vector<optional<std::string>> result(keys.size());
+          if (nullptr != detail::scope) {
+              for (std::size_t i = 0; i < keys.size(); i++) {
+                  auto value = detail::scope->find(keys[i]);
+                  if (!value.empty()) {
+                      result[i] = make_optional(std::move(value));
+                  }
+              }
+              return result;
+          }
+
+          // positions of the keys the cache could not answer
+          std::vector<std::size_t> missing;
+          for (std::size_t i = 0; i < keys.size(); i++) {
+              std::string value;
+              if (detail::cache().get(keys[i], value)) {
+                  if (!value.empty()) {
+                      result[i] = make_optional(std::move(value));
+                  }
+              } else {
+                  missing.push_back(i);
+              }
+          }
+          if (missing.empty()) {
+              return result;
+          }
+          if (nullptr == detail::db) {
+              detail::loadDb();
+          }
+          if (nullptr == detail::db) {
+              logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+              return result;
+          }
+
+          std::sort(missing.begin(), missing.end(), [&keys](std::size_t a, std::size_t b) {
+              return keys[a] < keys[b];
+          });
+          std::vector<std::string> sorted;
+          std::vector<std::uint64_t> generations;
+          for (auto &&i : missing) {
+              sorted.push_back(keys[i]);
+              generations.push_back(detail::cache().generation(keys[i]));
+          }
+          std::vector<std::string> values(sorted.size());
+
+          const auto snapshot = detail::db->GetSnapshot();
+          static const std::size_t threshold =
+              std::max<std::size_t>(1, config::IrohaConfigManager::getInstance().getMultiGetFanoutThreshold(1024));
+          const auto chunks = std::min<std::size_t>(
+              std::max<std::size_t>(1, std::thread::hardware_concurrency()),
+              (sorted.size() + threshold - 1) / threshold);
+          const auto chunkSize = (sorted.size() + chunks - 1) / chunks;
+          std::vector<std::future<void>> helpers;
+          std::size_t done = chunkSize;
+          try {
+              for (std::size_t first = chunkSize; first < sorted.size(); first += chunkSize) {
+                  const auto last = std::min(first + chunkSize, sorted.size());
+                  helpers.push_back(detail::readers().process([&, first, last] {
+                      detail::readSorted(sorted, first, last, snapshot, values);
+                  }));
+                  done = last;
+              }
+          } catch (const std::exception &e) {
+              logger::warning("WorldStateRepositoryWithLeveldb") << e.what();
+          }
+          // the first chunk, and whatever the pool would not take
+          detail::readSorted(sorted, 0, std::min(chunkSize, sorted.size()), snapshot, values);
+          if (done < sorted.size()) {
+              detail::readSorted(sorted, done, sorted.size(), snapshot, values);
+          }
+          for (auto &&helper : helpers) {
+              helper.wait();
+          }
+          detail::db->ReleaseSnapshot(snapshot);
+
+          for (std::size_t j = 0; j < missing.size(); j++) {
+              detail::cache().fill(sorted[j], values[j], generations[j]);
+              if (!values[j].empty()) {
+                  result[missing[j]] = make_optional(std::move(values[j]));
+              }
+          }
+          return result;
+      }
+
+      lru::Stats cacheStats() {
+          return detail::cache().stats();
+      }
+
+      ScopeGuard::ScopeGuard(Scope *scope): previous_(detail::scope) {
+          detail::scope = scope;
+      }
+
+      ScopeGuard::~ScopeGuard() {
+          detail::scope = previous_;
+      }
+
+      Scope *currentScope() {
+          return detail::scope;
+      }
+
+      std::string BlockOverlay::find(const std::string &key) {
+          {
+              std::lock_guard<std::mutex> lock(mutex_);
+              auto it = entries_.find(key);
+              if (it != entries_.end()) {
+                  return it->second.value;
+              }
+          }
+          std::string value;
+          {
+              ScopeGuard database(nullptr);
+              value = world_state_repository::find(key);
+          }
+          std::lock_guard<std::mutex> lock(mutex_);
+          // a write that raced the read wins
+          return entries_.emplace(key, Entry{value, false}).first->second.value;
+      }
+
+      void BlockOverlay::put(const std::string &key, const std::string &value) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          entries_[key] = Entry{value, true};
+      }
+
+      void BlockOverlay::erase(const std::string &key) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          entries_[key] = Entry{"", true};
+      }
+
+      bool BlockOverlay::commit() {
+          if (nullptr == detail::db) {
+              detail::loadDb();
+          }
+          std::lock_guard<std::mutex> lock(mutex_);
+          leveldb::WriteBatch batch;
+          for (auto&& entry : entries_) {
+              if (!entry.second.dirty) {
+                  continue;
+              }
+              if (entry.second.value.empty()) {
+                  batch.Delete(entry.first);
+              } else {
+                  batch.Put(entry.first, entry.second.value);
+              }
+          }
+          if (nullptr != detail::db) {
+              const bool written = detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
+              for (auto&& entry : entries_) {
+                  if (written && entry.second.dirty) {
+                      detail::cache().put(entry.first, entry.second.value);
+                  } else if (entry.second.dirty) {
+                      detail::cache().erase(entry.first);
+                  }
+              }
+              if (written) {
+                  entries_.clear();
+              }
+              return written;
+          }
+          logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+          return false;
       }
 
       void finish(){
@@ -70,17 +357,31 @@ namespace repository {
           if (nullptr != detail::db) {
               logger::info("WorldStateRepositoryWithLeveldb") << "delete db pointer";
               delete detail::db;
+              detail::db = nullptr;
           }
+          delete detail::blockCache;
+          detail::blockCache = nullptr;
+          delete detail::filterPolicy;
+          detail::filterPolicy = nullptr;
       }
 
       bool add(const std::string &key, const std::string &value) {
+          if (nullptr != detail::scope) {
+              detail::scope->put(key, value);
+              return true;
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
           if(nullptr != detail::db) {
 
               logger::info("WorldStateRepositoryWithLeveldb") << "Add:" << key;
-              return detail::loggerStatus(detail::db->Put(leveldb::WriteOptions(), key, value));
+              if (detail::loggerStatus(detail::db->Put(leveldb::WriteOptions(), key, value))) {
+                  detail::cache().put(key, value);
+                  return true;
+              }
+              detail::cache().erase(key);
+              return false;
           }
           logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
           return false;
@@ -88,6 +389,12 @@ namespace repository {
 
       template <>
       bool addBatch<std::string>(const std::vector<std::tuple<std::string, std::string>> &tuples){
+          if (nullptr != detail::scope) {
+              for (auto&& tuple : tuples) {
+                  detail::scope->put(std::get<0>(tuple), std::get<1>(tuple));
+              }
+              return true;
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
@@ -98,39 +405,95 @@ namespace repository {
           }
 
           if(nullptr != detail::db) {
-              return detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
+              const bool written = detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
+              for (auto&& tuple : tuples) {
+                  if (written) {
+                      detail::cache().put(std::get<0>(tuple), std::get<1>(tuple));
+                  } else {
+                      detail::cache().erase(std::get<0>(tuple));
+                  }
+              }
+              return written;
           }
           logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
           return false;
       }
 
-      std::vector<std::string> findAll(){
-          logger::info("WorldStateRepositoryWithLeveldb") << "findAll";
+      struct Cursor::Impl {
+          std::string prefix;
+          std::unique_ptr<leveldb::Iterator> it;
+      };
+
+      Cursor::Cursor(const std::string &prefix, const std::string &resumeToken)
+          : impl_(new Impl{prefix, nullptr}) {
+          if (!resumeToken.empty() && !leveldb::Slice(resumeToken).starts_with(prefix)) {
+              // it would resume outside the prefix and look like the end
+              throw std::invalid_argument("resume token is not under " + prefix);
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
-          std::vector<std::string> res;
-          leveldb::Iterator* it = detail::db->NewIterator(leveldb::ReadOptions());
-          for (it->SeekToFirst(); it->Valid(); it->Next()) {
-              res.push_back( it->value().ToString() );
+          if (nullptr == detail::db) {
+              logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+              return;
+          }
+          impl_->it.reset(detail::db->NewIterator(leveldb::ReadOptions()));
+          if (resumeToken.empty()) {
+              impl_->it->Seek(prefix);
+          } else {
+              // the token is the last key handed out
+              impl_->it->Seek(resumeToken);
+              if (impl_->it->Valid() && impl_->it->key() == leveldb::Slice(resumeToken)) {
+                  impl_->it->Next();
+              }
           }
-          delete it;
-          return res;
       }
 
-      std::vector<std::string> findByPrefix(const std::string& prefix){
-          if (nullptr == detail::db) {
-              detail::loadDb();
+      Cursor::~Cursor() = default;
+
+      bool Cursor::valid() const {
+          return impl_->it && impl_->it->Valid() && impl_->it->key().starts_with(impl_->prefix);
+      }
+
+      void Cursor::next() {
+          impl_->it->Next();
+      }
+
+      std::string Cursor::key() const {
+          return impl_->it->key().ToString();
+      }
+
+      std::string Cursor::value() const {
+          return impl_->it->value().ToString();
+      }
+
+      std::string Cursor::resumeToken() const {
+          return key();
+      }
+
+      Page findPage(const std::string &prefix, const std::string &resumeToken, std::size_t limit) {
+          Page page;
+          Cursor cursor(prefix, resumeToken);
+          for (; cursor.valid() && page.values.size() < std::max<std::size_t>(1, limit); cursor.next()) {
+              page.values.push_back(cursor.value());
+              page.resumeToken = cursor.resumeToken();
+          }
+          if (!cursor.valid()) {
+              page.resumeToken.clear();
           }
+          return page;
+      }
+
+      std::vector<std::string> findAll(){
+          logger::info("WorldStateRepositoryWithLeveldb") << "findAll";
+          return findByPrefix("");
+      }
+
+      std::vector<std::string> findByPrefix(const std::string& prefix){
           std::vector<std::string> res;
-          leveldb::Iterator* it = detail::db->NewIterator(leveldb::ReadOptions());
-          for(it->Seek(prefix);
-           it->Valid() && it->key().ToString() < prefix + "~";
-           it->Next()
-          ){
-              res.push_back( it->value().ToString() );
-          }
-          delete it;
+          for (Cursor cursor(prefix); cursor.valid(); cursor.next()) {
+              res.push_back(cursor.value());
+          }
           return res;
       }
 
@@ -146,85 +509,118 @@ namespace repository {
               batch.Put(std::get<0>(tuple), std::get<1>(tuple));
           }
 
-          return detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
+          const bool written = detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
+          for (auto&& tuple : tuples) {
+              detail::cache().erase(std::get<0>(tuple));
+          }
+          return written;
       }
 
       bool update(const std::string &key, const std::string &value) {
+          if (nullptr != detail::scope) {
+              if (detail::scope->find(key).empty()) {
+                  return false;
+              }
+              detail::scope->put(key, value);
+              return true;
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
           if(nullptr != detail::db) {
-              std::string dummy;
-              if (detail::loggerStatus(detail::db->Get(leveldb::ReadOptions(), key, &dummy))) {
-                  leveldb::WriteBatch batch;
-                  batch.Delete(key);
-                  batch.Put(key, value);
-                  return detail::loggerStatus(detail::db->Write(leveldb::WriteOptions(), &batch));
-              }
-              return false;
+              return !detail::read(key).empty() && put(key, value);
           }
           logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
           return false;
       }
 
       bool remove(const std::string &key) {
+          if (nullptr != detail::scope) {
+              if (detail::scope->find(key).empty()) {
+                  return false;
+              }
+              detail::scope->erase(key);
+              return true;
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
           if(nullptr != detail::db) {
-              std::string dummy;
-              if (detail::loggerStatus(detail::db->Get(leveldb::ReadOptions(), key, &dummy))) {
-                  return detail::loggerStatus(detail::db->Delete(leveldb::WriteOptions(), key));
-              }
-              return false;
+              return !detail::read(key).empty() && erase(key);
           }
           logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
           return false;
       }
 
       std::string find(const std::string &key) {
-          if (nullptr == detail::db) {
-              detail::loadDb();
+          if (nullptr != detail::scope) {
+              return detail::scope->find(key);
           }
-          if(nullptr != detail::db) {
-              logger::info("WorldStateRepositoryWithLeveldb") << "Find:" << key;
-              std::string readData;
-              detail::loggerStatus(detail::db->Get(leveldb::ReadOptions(), key, &readData));
-              if (!readData.empty()) {
-                  return readData;
-              } else {
-                  return "";
-              }
-          }
-          logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
-          return "";
+          return detail::read(key);
       }
 
       std::string findOrElse(
               const std::string &key,
               const std::string &defaultValue
       ) {
-          if (nullptr == detail::db) {
-              detail::loadDb();
+          if (nullptr != detail::scope) {
+              auto result = detail::scope->find(key);
+              return result.empty() ? defaultValue : result;
           }
+          auto result = detail::read(key);
+          return result.empty() ? defaultValue : result;
+      }
 
-          std::string result;
-          detail::loggerStatus(detail::db->Get(leveldb::ReadOptions(), key, &result));
-          if (!result.empty()) {
-              return result;
-          } else {
-              return defaultValue;
+      bool exists(const std::string &key) {
+          if (nullptr != detail::scope) {
+              return !detail::scope->find(key).empty();
           }
+          return !detail::read(key).empty();
       }
 
-      bool exists(const std::string &key) {
+      optional<std::string> tryFind(const std::string &key) {
+          auto value = nullptr != detail::scope ? detail::scope->find(key) : detail::read(key);
+          if (value.empty()) {
+              return nullopt;
+          }
+          return make_optional(std::move(value));
+      }
+
+      bool put(const std::string &key, const std::string &value) {
+          if (nullptr != detail::scope) {
+              detail::scope->put(key, value);
+              return true;
+          }
           if (nullptr == detail::db) {
               detail::loadDb();
           }
+          if (nullptr != detail::db) {
+              if (detail::loggerStatus(detail::db->Put(leveldb::WriteOptions(), key, value))) {
+                  detail::cache().put(key, value);
+                  return true;
+              }
+              detail::cache().erase(key);
+              return false;
+          }
+          logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+          return false;
+      }
 
-          std::string result;
-          detail::loggerStatus(detail::db->Get(leveldb::ReadOptions(), key, &result));
-          return !result.empty();
+      bool erase(const std::string &key) {
+          if (nullptr != detail::scope) {
+              detail::scope->erase(key);
+              return true;
+          }
+          if (nullptr == detail::db) {
+              detail::loadDb();
+          }
+          if (nullptr != detail::db) {
+              const bool erased = detail::loggerStatus(detail::db->Delete(leveldb::WriteOptions(), key));
+              detail::cache().erase(key);
+              return erased;
+          }
+          logger::error("WorldStateRepositoryWithLeveldb") << "Error DB already held by process";
+          return false;
       }
   };
 };
@@ -26,6 +26,7 @@ limitations under the License.
 #include <service/peer_service.hpp>
 #include <transaction_builder/transaction_builder.hpp>
 #include <util/logger.hpp>
+#include <util/timer_wheel.hpp>
 
 // -- WIP --
 #include <grpc++/grpc++.h>
@@ -179,6 +180,20 @@ namespace http {
             return res;
         });
 
+        // metrics of the process-wide timer wheel
+        Cappuccino::route<Cappuccino::Method::GET>( "/stats/timers",[](std::shared_ptr<Request> request) -> Response{
+            auto res = Response(request);
+            const auto stats = timer::stats();
+            res.json(json({
+              {"status",    200},
+              {"pending",   stats.pending},
+              {"scheduled", stats.scheduled},
+              {"fired",     stats.fired},
+              {"cancelled", stats.cancelled}
+            }));
+            return res;
+        });
+
         logger::info("server") << "start server!";
         // runnning
         Cappuccino::run();
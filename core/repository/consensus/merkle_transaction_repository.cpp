@@ -41,13 +41,13 @@ namespace merkle_transaction_repository {
         return hash::sha3_256_hex(s);
     }
 
-    std::string calculateNewRootHash(const ConsensusEvent& event,
+    std::string calculateNewRootHash(const std::string& leafHash,
                                      std::vector<std::tuple<std::string, std::string>> &batchCommit) {
         std::string lastInsertion = repository::world_state_repository::find("last_insertion");
         
         if (lastInsertion.empty()) {
-            // Note: there is no need to update the tree's DB here, because there is only one transaction--the current!
-            return hash(event.transaction());
+            // Note: there is no need to update the tree's DB here, because there is only one leaf--the current!
+            return leafHash;
         }
 
         std::string parent = repository::world_state_repository::find(lastInsertion + "_parent");
@@ -55,8 +55,8 @@ namespace merkle_transaction_repository {
         std::string rightChild = repository::world_state_repository::find(parent + "_rightChild");
 
         if (rightChild.empty()) {
-            // insert the event's transaction as the right child
-            rightChild = hash(event.transaction());
+            // insert the event's block as the right child
+            rightChild = leafHash;
             std::string newParentHash = hash(leftChild + rightChild);
 
             if (!batchCommit.empty()) { // TODO: this may not be the best comparison to use
@@ -85,7 +85,7 @@ namespace merkle_transaction_repository {
             return rightChild;
 
         } else {
-            std::string newLeftChild = hash(event.transaction());
+            std::string newLeftChild = leafHash;
             std::string newParentHash = hash(newLeftChild);
 
             std::string oldParent = parent;
@@ -95,9 +95,9 @@ namespace merkle_transaction_repository {
             while (!parent.empty()) {
 
                 if (!batchCommit.empty()) { // TODO: this may not be the best comparison to use
-                    batchCommit.emplace_back(hash(event.transaction()) + "_parent",
+                    batchCommit.emplace_back(leafHash + "_parent",
                                              newParentHash);
-                    batchCommit.emplace_back(hash(event.transaction()) + "_leftChild",
+                    batchCommit.emplace_back(leafHash + "_leftChild",
                                              newLeftChild);
                     // TODO: delete old, unused nodes
                 }
@@ -114,7 +114,7 @@ namespace merkle_transaction_repository {
 
             // save new root
             if (!batchCommit.empty()) { // TODO: this may not be the best comparison to use
-                batchCommit.emplace_back(hash(event.transaction()) + "merkle_root",
+                batchCommit.emplace_back(leafHash + "merkle_root",
                                          newParentHash);
                 // TODO: delete old, unused nodes
             }
@@ -124,15 +124,28 @@ namespace merkle_transaction_repository {
     }
 
     //TODO: change bool to throw an exception instead
-    bool commit(const ConsensusEvent& event) {
-        auto h = hash(event.transaction());
+    bool commit(const ConsensusEvent& event, const std::string& digest,
+                const std::vector<std::string>& transactionDigests,
+                const SignatureSet& signatures) {
+        Api::CommitCertificate certificate;
+        certificate.set_digest(digest);
+        certificate.set_order(event.order());
+        *certificate.mutable_signatures() = signatures;
         std::vector<std::tuple<std::string, std::string>> batchCommit
                 = {
-                        std::make_tuple("last_insertion", h),
-                        std::make_tuple(h, event.transaction().SerializeAsString())
+                        std::make_tuple("last_insertion", digest),
+                        std::make_tuple("last_order", std::to_string(event.order())),
+                        std::make_tuple(digest, event.block().SerializeAsString()),
+                        std::make_tuple("commit_" + std::to_string(event.order()),
+                                        certificate.SerializeAsString())
                 };
+        const auto& transactions = event.block().transactions();
+        for (int i = 0; i < transactions.size(); i++) {
+            batchCommit.emplace_back(transactionDigests.at(i),
+                                     transactions.Get(i).SerializeAsString());
+        }
 
-        calculateNewRootHash(event, batchCommit);
+        calculateNewRootHash(digest, batchCommit);
 
         return repository::world_state_repository::addBatch<std::string>(batchCommit);
     }
@@ -141,8 +154,29 @@ namespace merkle_transaction_repository {
         return !repository::world_state_repository::find(hash).empty();
     }
 
+    std::uint64_t getLastLeafOrder() {
+        auto order = repository::world_state_repository::findOrElse("last_order", "0");
+        return std::stoull(order);
+    }
+
     std::string getLeaf(const std::string& hash) {
         return repository::world_state_repository::find(hash);
     }
 
+    bool findCommitted(std::uint64_t order, ConsensusEvent& event) {
+        auto stored = repository::world_state_repository::tryFind("commit_" + std::to_string(order));
+        Api::CommitCertificate certificate;
+        if (!stored || !certificate.ParseFromString(*stored)) {
+            return false;
+        }
+        auto block = repository::world_state_repository::tryFind(certificate.digest());
+        if (!block || !event.mutable_block()->ParseFromString(*block)) {
+            return false;
+        }
+        event.set_order(order);
+        event.set_status("commited");
+        *event.mutable_signatureset() = certificate.signatures();
+        return true;
+    }
+
 };  // namespace merkle_transaction_repository
@@ -18,15 +18,19 @@ limitations under the License.
 #ifndef CORE_REPOSITORY_MERKLETRANSACTIONREPOSITORY_HPP_
 #define CORE_REPOSITORY_MERKLETRANSACTIONREPOSITORY_HPP_
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+#include <tuple>
 
 #include <infra/protobuf/api.pb.h>
 
 namespace merkle_transaction_repository {
 
 using Api::ConsensusEvent;
+using Api::SignatureSet;
 
 struct MerkleNode {
     std::string hash;
@@ -56,14 +60,26 @@ struct MerkleNode {
 };
 
 //TODO: change bool to throw an exception instead
-bool commit(const ConsensusEvent& event);
+// Appends the event's block as one leaf under digest and stores each
+// transaction under its digest; both are computed once by the caller. The
+// signatures the block was committed with are kept under its order.
+bool commit(const ConsensusEvent& event, const std::string& digest,
+            const std::vector<std::string>& transactionDigests,
+            const SignatureSet& signatures);
+
+// The committed event of that order, with the signatures it was committed
+// with, for a peer that missed the commit; false if there is none.
+bool findCommitted(std::uint64_t order, ConsensusEvent& event);
 
 bool leafExists(const std::string& hash);
 
+// Order of the last committed block, 0 if nothing was committed yet.
+std::uint64_t getLastLeafOrder();
+
 std::string getLeaf(const std::string& hash);
 
-std::string calculateNewRoot(
-    const ConsensusEvent& event,
+std::string calculateNewRootHash(
+    const std::string& leafHash,
     std::vector<std::tuple<std::string,std::string>> &batchCommit
 );
 
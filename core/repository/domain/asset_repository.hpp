@@ -19,7 +19,10 @@ limitations under the License.
 
 #include <infra/protobuf/api.pb.h>
 #include <transaction_builder/transaction_builder.hpp>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace repository {
@@ -50,6 +53,51 @@ namespace repository {
             const std::string &publicKey,
             const std::string &assetName
         );
+
+        // One batched read for many (publicKey, assetName) pairs, answered
+        // in order; an empty Asset where there is none.
+        std::vector<Api::Asset> findMany(
+            const std::vector<std::pair<std::string, std::string>> &publicKeyAndNames
+        );
+
+        /**
+         * While alive, keeps the assets the calling thread touches decoded
+         * in memory: each is parsed once, add/update/remove only change the
+         * decoded copy, and flush() serialises every changed asset once, no
+         * matter how many transactions of the block changed it.
+         */
+        class BlockTable {
+        public:
+            struct Entry {
+                Api::Asset asset;
+                bool present;
+                bool dirty;
+            };
+
+            BlockTable();
+            ~BlockTable();
+            BlockTable(const BlockTable &) = delete;
+            BlockTable &operator=(const BlockTable &) = delete;
+
+            // Loads key from world state on first use.
+            Entry &entry(const std::string &key);
+
+            // Writes the changed assets to world state; the table stays
+            // installed and usable.
+            bool flush();
+
+        private:
+            BlockTable *previous_;
+            std::unordered_map<std::string, Entry> entries_;
+        };
+
+        struct CoalescingStats {
+            std::uint64_t updates; // add/update/remove against a table
+            std::uint64_t writes;  // assets serialised by flush()
+            std::uint64_t loads;   // assets parsed into a table
+        };
+
+        CoalescingStats coalescingStats();
     }
 }
 
@@ -46,10 +46,7 @@ namespace account {
         const std::string &publicKey,
         const Api::Account &account
     ){
-      if(world_state_repository::exists("account_" + publicKey)){
-        return world_state_repository::update("account_" + publicKey, account.SerializeAsString());
-      }
-      return false;
+      return world_state_repository::update("account_" + publicKey, account.SerializeAsString());
     }
 
     /********************************************************************************************
@@ -58,18 +55,15 @@ namespace account {
     bool remove(
         const std::string &publicKey
     ){
-      if(world_state_repository::exists("account_" + publicKey)){
-        return world_state_repository::remove("account_" + publicKey);
-      }
-      return false;
+      return world_state_repository::remove("account_" + publicKey);
     }
 
     Api::Account find(
         const std::string &publicKey
     ){
       Api::Account res;
-      if(world_state_repository::exists("account_" + publicKey)){
-        res.ParseFromString(world_state_repository::find("account_" + publicKey));
+      if (auto serialized = world_state_repository::tryFind("account_" + publicKey)) {
+        res.ParseFromString(*serialized);
       }
       return res;
     }
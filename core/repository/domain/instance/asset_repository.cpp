@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "../asset_repository.hpp"
 #include "common_repository.hpp"
+#include <atomic>
 #include <crypto/hash.hpp>
 #include <repository/world_state_repository.hpp>
 #include <transaction_builder/transaction_builder.hpp>
@@ -30,11 +31,76 @@ const auto ValuePrefix = common::Prefix("Asset::");
 namespace repository {
 namespace asset {
 
+    namespace detail {
+        thread_local BlockTable *table = nullptr;
+
+        std::atomic<std::uint64_t> updates{0};
+        std::atomic<std::uint64_t> writes{0};
+        std::atomic<std::uint64_t> loads{0};
+
+        BlockTable::Entry &change(BlockTable::Entry &entry) {
+            entry.dirty = true;
+            updates++;
+            return entry;
+        }
+    }
+
+    BlockTable::BlockTable(): previous_(detail::table) {
+        detail::table = this;
+    }
+
+    BlockTable::~BlockTable() {
+        detail::table = previous_;
+    }
+
+    BlockTable::Entry &BlockTable::entry(const std::string &key) {
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            return it->second;
+        }
+        auto &entry = entries_[key];
+        auto serialized = world_state_repository::find(key);
+        entry.present = !serialized.empty();
+        entry.dirty = false;
+        if (entry.present) {
+            entry.asset.ParseFromString(serialized);
+            detail::loads++;
+        }
+        return entry;
+    }
+
+    bool BlockTable::flush() {
+        bool ok = true;
+        for (auto&& entry : entries_) {
+            if (!entry.second.dirty) {
+                continue;
+            }
+            if (entry.second.present) {
+                ok = world_state_repository::add(entry.first, entry.second.asset.SerializeAsString()) && ok;
+            } else {
+                world_state_repository::remove(entry.first);
+            }
+            entry.second.dirty = false;
+            detail::writes++;
+        }
+        return ok;
+    }
+
+    CoalescingStats coalescingStats() {
+        return CoalescingStats{detail::updates.load(), detail::writes.load(), detail::loads.load()};
+    }
+
     bool add(
         const std::string &publicKey,
         const std::string &assetName,
         const Api::Asset  &asset
     ){
+      if (nullptr != detail::table) {
+        auto &entry = detail::change(detail::table->entry("asset_" + publicKey + '_' + assetName));
+        entry.asset = asset;
+        entry.present = true;
+        return true;
+      }
       return world_state_repository::add("asset_" + publicKey + '_' + assetName, asset.SerializeAsString());
     }
 
@@ -43,34 +109,75 @@ namespace asset {
         const std::string &assetName,
         const Api::Asset &asset
     ){
-      if(world_state_repository::exists("asset_" + publicKey + '_' + assetName)){
-        return world_state_repository::update("asset_" + publicKey + '_' + assetName, asset.SerializeAsString());
+      if (nullptr != detail::table) {
+        auto &entry = detail::table->entry("asset_" + publicKey + '_' + assetName);
+        if (!entry.present) {
+          return false;
+        }
+        detail::change(entry).asset = asset;
+        return true;
       }
-      return false;
+      return world_state_repository::update("asset_" + publicKey + '_' + assetName, asset.SerializeAsString());
     }
 
     bool remove(
         const std::string &publicKey,
         const std::string &assetName
     ){
-      if(world_state_repository::exists("asset_" + publicKey + '_' + assetName)){
-        return world_state_repository::remove("asset_" + publicKey + '_' + assetName);
+      if (nullptr != detail::table) {
+        auto &entry = detail::table->entry("asset_" + publicKey + '_' + assetName);
+        if (!entry.present) {
+          return false;
+        }
+        detail::change(entry).present = false;
+        entry.asset.Clear();
+        return true;
       }
-      return false;
+      return world_state_repository::remove("asset_" + publicKey + '_' + assetName);
     }
 
     Api::Asset find(
             const std::string &publicKey,
             const std::string &assetName
     ){
+        if (nullptr != detail::table) {
+            const auto &entry = detail::table->entry("asset_" + publicKey + '_' + assetName);
+            return entry.present ? entry.asset : Api::Asset();
+        }
         Api::Asset res;
         logger::info("AssetRepository") << "Find:" << "asset_" + publicKey + '_' + assetName;
         logger::info("AssetRepository") << "Find:" << "pub:" + publicKey;
         logger::info("AssetRepository") << "Find:" << "name:" + assetName;
-        if(world_state_repository::exists("asset_" + publicKey + '_' + assetName)){
+        if (auto serialized = world_state_repository::tryFind("asset_" + publicKey + '_' + assetName)) {
             logger::info("AssetRepository") << "Ok exists";
 
-            res.ParseFromString(world_state_repository::find("asset_" + publicKey + '_' + assetName));
+            res.ParseFromString(*serialized);
+        }
+        return res;
+    }
+
+    std::vector<Api::Asset> findMany(
+            const std::vector<std::pair<std::string, std::string>> &publicKeyAndNames
+    ){
+        std::vector<Api::Asset> res(publicKeyAndNames.size());
+        std::vector<std::string> keys;
+        for (auto&& key : publicKeyAndNames) {
+            keys.push_back("asset_" + key.first + '_' + key.second);
+        }
+        if (nullptr != detail::table) {
+            for (std::size_t i = 0; i < keys.size(); i++) {
+                const auto &entry = detail::table->entry(keys[i]);
+                if (entry.present) {
+                    res[i] = entry.asset;
+                }
+            }
+            return res;
+        }
+        auto serialized = world_state_repository::multiGet(keys);
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (serialized[i]) {
+                res[i].ParseFromString(*serialized[i]);
+            }
         }
         return res;
     }
@@ -79,6 +186,9 @@ namespace asset {
             const std::string &publicKey,
             const std::string &assetName
     ){
+        if (nullptr != detail::table) {
+            return detail::table->entry("asset_" + publicKey + '_' + assetName).present;
+        }
         return world_state_repository::exists("asset_" + publicKey + '_' + assetName);
     }
 
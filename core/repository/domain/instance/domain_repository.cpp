@@ -61,13 +61,12 @@ std::string add(const std::string &ownerPublicKey, const std::string &name) {
  * Update<Domain>
  ********************************************************************************************/
 bool update(const std::string &uuid, const std::string &name) {
-  if (exists(uuid)) {
-    const auto rval = world_state_repository::find(uuid);
+  if (const auto rval = world_state_repository::tryFind(uuid)) {
     logger::explore(NameSpaceID) << "Update<Domain> uuid: " << uuid << ", name:" << name;
-    auto domain = common::parse<Api::Domain>(rval, ValuePrefix);
+    auto domain = common::parse<Api::Domain>(*rval, ValuePrefix);
     *domain.mutable_name() = name;
     const auto strDomain = common::stringify<Api::Domain>(domain, ValuePrefix);
-    return world_state_repository::update(uuid, strDomain);
+    return world_state_repository::put(uuid, strDomain);
   }
   return false;
 }
@@ -76,11 +75,8 @@ bool update(const std::string &uuid, const std::string &name) {
  * Remove<Domain>
  ********************************************************************************************/
 bool remove(const std::string &uuid) {
-  if (exists(uuid)) {
-    logger::explore(NameSpaceID) << "Remove<Domain> uuid: " << uuid;
-    return world_state_repository::remove(uuid);
-  }
-  return false;
+  logger::explore(NameSpaceID) << "Remove<Domain> uuid: " << uuid;
+  return world_state_repository::remove(uuid);
 }
 
 /********************************************************************************************
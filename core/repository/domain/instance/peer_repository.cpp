@@ -79,17 +79,16 @@ std::string add(const std::string &publicKey, const std::string &address,
  ********************************************************************************************/
 bool update(const std::string &uuid, const std::string &address,
             const Api::Trust &trust) {
-  if (exists(uuid)) {
-    const auto rval = world_state_repository::find(uuid);
+  if (const auto rval = world_state_repository::tryFind(uuid)) {
     logger::explore(NameSpaceID) << "Update<Peer> uuid: " << uuid
                                  << ", address: " << address
 
                                  << ", trust: " << trust.value();
-    auto peer = common::parse<Api::Peer>(rval, ValuePrefix);
+    auto peer = common::parse<Api::Peer>(*rval, ValuePrefix);
     *peer.mutable_address() = address;
     *peer.mutable_trust() = trust;
     const auto strPeer = common::stringify<Api::Peer>(peer, ValuePrefix);
-    return world_state_repository::update(uuid, strPeer);
+    return world_state_repository::put(uuid, strPeer);
   }
   return false;
 }
@@ -98,11 +97,8 @@ bool update(const std::string &uuid, const std::string &address,
  * Remove<Peer>
  ********************************************************************************************/
 bool remove(const std::string &uuid) {
-  if (exists(uuid)) {
-    logger::explore(NameSpaceID) << "Remove<Peer> uuid: " << uuid;
-    return world_state_repository::remove(uuid);
-  }
-  return false;
+  logger::explore(NameSpaceID) << "Remove<Peer> uuid: " << uuid;
+  return world_state_repository::remove(uuid);
 }
 
 /********************************************************************************************
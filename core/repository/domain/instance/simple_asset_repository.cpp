@@ -77,14 +77,13 @@ std::string add(const std::string &domain, const std::string &name,
  * Update<SimpleAsset>
  ********************************************************************************************/
 bool update(const std::string &uuid, const Api::BaseObject &value) {
-  if (exists(uuid)) {
-    const auto rval = world_state_repository::find(uuid);
+  if (const auto rval = world_state_repository::tryFind(uuid)) {
     logger::explore(NameSpaceID) << "Update<SimpleAsset> uuid: " << uuid << ", "
                                  << "value: " << txbuilder::stringify(value);
-    auto simpleAsset = detail::parseSimpleAsset(rval);
+    auto simpleAsset = detail::parseSimpleAsset(*rval);
     *simpleAsset.mutable_value() = value;
     const auto strSimpleAsset = detail::stringifySimpleAsset(simpleAsset);
-    return world_state_repository::update(uuid, strSimpleAsset);
+    return world_state_repository::put(uuid, strSimpleAsset);
   }
   return false;
 }
@@ -93,11 +92,8 @@ bool update(const std::string &uuid, const Api::BaseObject &value) {
  * Remove<SimpleAsset>
  ********************************************************************************************/
 bool remove(const std::string &uuid) {
-  if (exists(uuid)) {
-    logger::explore(NameSpaceID) << "Remove<SimpleAsset> uuid: " << uuid;
-    return world_state_repository::remove(uuid);
-  }
-  return false;
+  logger::explore(NameSpaceID) << "Remove<SimpleAsset> uuid: " << uuid;
+  return world_state_repository::remove(uuid);
 }
 
 /********************************************************************************************
@@ -33,23 +33,35 @@ namespace repository{
 
         std::vector<Transaction> findAll(){
             std::vector<Transaction> res;
-            auto txstr = world_state_repository::findByPrefix("transaction_");
-            for(auto txs: txstr){
-                Transaction tx;
-                tx.ParseFromString(txs);
-                res.push_back(tx);
+            for (world_state_repository::Cursor cursor("transaction_"); cursor.valid(); cursor.next()) {
+                res.emplace_back();
+                res.back().ParseFromString(cursor.value());
             }
             return res;
         }
 
+        Page findPage(const std::string &resumeToken, std::size_t limit){
+            auto stored = world_state_repository::findPage("transaction_", resumeToken, limit);
+            Page page;
+            page.transactions.resize(stored.values.size());
+            for (std::size_t i = 0; i < stored.values.size(); i++) {
+                page.transactions[i].ParseFromString(stored.values[i]);
+            }
+            page.resumeToken = std::move(stored.resumeToken);
+            return page;
+        }
+
         Transaction find(std::string hash){
-            std::vector<Transaction> res;
             Transaction tx;
-            if(world_state_repository::exists("transaction_" + hash)){
-                tx.ParseFromString(world_state_repository::find("transaction_" + hash));
+            if (auto serialized = world_state_repository::tryFind("transaction_" + hash)) {
+                tx.ParseFromString(*serialized);
             }
             return tx;
         }
 
+        bool exists(const std::string& hash){
+            return world_state_repository::exists("transaction_" + hash);
+        }
+
     }
 }
\ No newline at end of file
@@ -30,10 +30,23 @@ namespace repository{
 
         bool add(const std::string &hash, const Api::Transaction& tx);
 
+        // Reads the whole ledger into memory; prefer findPage.
         std::vector<Api::Transaction> findAll();
 
+        struct Page {
+            std::vector<Api::Transaction> transactions;
+            std::string resumeToken; // empty once the ledger is exhausted
+        };
+
+        // Up to limit transactions, continuing from resumeToken. Throws
+        // std::invalid_argument for a token no page handed out.
+        Page findPage(const std::string &resumeToken, std::size_t limit);
+
         Api::Transaction find(const std::string& key);
 
+        // Whether a transaction with this hash is on the ledger.
+        bool exists(const std::string& hash);
+
     }
 }
 
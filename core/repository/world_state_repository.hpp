@@ -20,7 +20,12 @@ limitations under the License.
 
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+
+#include <util/lru_cache.hpp>
+#include <util/use_optional.hpp>
 
 namespace repository {
 
@@ -40,10 +45,47 @@ namespace repository {
 
       bool remove(const std::string &key);
 
+      // Both read every match into memory; prefer a Cursor.
       std::vector<std::string> findAll();
 
       std::vector<std::string> findByPrefix(const std::string& prefix);
 
+      /**
+       * Walks the keys under a prefix in key order, one entry at a time,
+       * over a consistent view of the database. Reads the database even
+       * while a Scope is installed.
+       */
+      class Cursor {
+      public:
+          // Starts after the entry resumeToken was taken at, or at the first
+          // key under prefix if it is empty. Throws std::invalid_argument
+          // if resumeToken is not a key under prefix.
+          explicit Cursor(const std::string &prefix, const std::string &resumeToken = "");
+          ~Cursor();
+          Cursor(const Cursor &) = delete;
+          Cursor &operator=(const Cursor &) = delete;
+
+          bool valid() const;
+          void next();
+          std::string key() const;
+          std::string value() const;
+          // Resumes a later Cursor right after the current entry.
+          std::string resumeToken() const;
+
+      private:
+          struct Impl;
+          std::unique_ptr<Impl> impl_;
+      };
+
+      struct Page {
+          std::vector<std::string> values;
+          std::string resumeToken; // empty once nothing is left
+      };
+
+      // Up to limit values under prefix, from resumeToken on; throws as
+      // Cursor does.
+      Page findPage(const std::string &prefix, const std::string &resumeToken, std::size_t limit);
+
       std::string find(const std::string &key);
 
       std::string findOrElse(
@@ -53,7 +95,79 @@ namespace repository {
 
       bool exists(const std::string &key);
 
+      // A single lookup: the value, or nullopt if the key is absent.
+      optional<std::string> tryFind(const std::string &key);
+
+      /**
+       * Looks up many keys at once, answering in the order of keys. Keys the
+       * cache does not hold are read in key order from one snapshot, with an
+       * iterator stepped forward between nearby keys instead of a fresh Get
+       * each; large batches are split over threads.
+       */
+      std::vector<optional<std::string>> multiGet(const std::vector<std::string> &keys);
+
+      // Blind writes, without a lookup first; erase succeeds on an absent
+      // key.
+      bool put(const std::string &key, const std::string &value);
+      bool erase(const std::string &key);
+
       void finish();
+
+      // Reads are served from a sharded LRU that writes go through and
+      // removals invalidate; world_state_cache_bytes bounds it.
+      lru::Stats cacheStats();
+
+      /**
+       * Stands in for the database on the thread that installs it, so a
+       * transaction can run against something other than committed state.
+       * As with the database, an empty value means the key is absent.
+       * findAll and findByPrefix always read the database.
+       */
+      class Scope {
+      public:
+          virtual ~Scope() = default;
+          virtual std::string find(const std::string &key) = 0;
+          virtual void put(const std::string &key, const std::string &value) = 0;
+          virtual void erase(const std::string &key) = 0;
+      };
+
+      // Installs scope on the calling thread for its lifetime; nullptr goes
+      // back to the database.
+      class ScopeGuard {
+      public:
+          explicit ScopeGuard(Scope *scope);
+          ~ScopeGuard();
+          ScopeGuard(const ScopeGuard &) = delete;
+          ScopeGuard &operator=(const ScopeGuard &) = delete;
+      private:
+          Scope *previous_;
+      };
+
+      // The scope installed on the calling thread, nullptr if none.
+      Scope *currentScope();
+
+      /**
+       * Holds everything a block reads and writes in memory; reads see the
+       * block's earlier writes. commit() writes the lot in one WriteBatch,
+       * so a block is applied entirely or not at all. Safe to read from
+       * several threads.
+       */
+      class BlockOverlay : public Scope {
+      public:
+          std::string find(const std::string &key) override;
+          void put(const std::string &key, const std::string &value) override;
+          void erase(const std::string &key) override;
+
+          bool commit();
+
+      private:
+          struct Entry {
+              std::string value; // empty: absent
+              bool dirty;
+          };
+          std::mutex mutex_;
+          std::unordered_map<std::string, Entry> entries_;
+      };
   };
 
 }; // namespace repository
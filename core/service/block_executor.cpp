@@ -0,0 +1,645 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <thread_pool.hpp>
+
+#include <infra/config/iroha_config_with_json.hpp>
+#include <repository/domain/asset_repository.hpp>
+#include <repository/world_state_repository.hpp>
+#include <service/executor.hpp>
+#include <util/logger.hpp>
+
+#include "block_executor.hpp"
+
+namespace block_executor {
+
+namespace detail {
+
+using repository::world_state_repository::Scope;
+using repository::world_state_repository::ScopeGuard;
+
+// txIndex of a value read from committed state
+constexpr std::size_t STORAGE = std::numeric_limits<std::size_t>::max();
+
+struct Version {
+  std::size_t txIndex;
+  std::size_t incarnation;
+
+  bool operator==(const Version &other) const {
+    return txIndex == other.txIndex && incarnation == other.incarnation;
+  }
+};
+
+using ReadSet = std::vector<std::pair<std::string, Version>>;
+using WriteSet = std::unordered_map<std::string, std::string>;
+
+// Thrown out of a read that hits the estimate of a lower transaction; the
+// reader waits until that transaction has run again.
+struct Dependency {
+  std::size_t blocking;
+};
+
+std::atomic<std::uint64_t> blocks{0};
+std::atomic<std::uint64_t> transactions{0};
+std::atomic<std::uint64_t> executions{0};
+std::atomic<std::uint64_t> aborts{0};
+std::atomic<std::uint64_t> suspensions{0};
+
+/**
+ * Every key written in the block maps to the values the transactions that
+ * wrote it left, by transaction index. A read by transaction i sees the
+ * value of the highest writer below i. An aborted transaction's values
+ * are marked as estimates: they will probably be written again, so readers
+ * wait rather than run on them.
+ */
+class MultiVersionMemory {
+ public:
+  enum class Status { FOUND, NOT_FOUND, ESTIMATE };
+
+  struct Result {
+    Status status;
+    Version version;
+    std::string value;
+  };
+
+  explicit MultiVersionMemory(std::size_t size) : transactions_(size) {}
+
+  Result read(const std::string &key, std::size_t txIndex) {
+    auto &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto versions = shard.keys.find(key);
+    if (versions == shard.keys.end()) {
+      return Result{Status::NOT_FOUND, Version{STORAGE, 0}, ""};
+    }
+    auto below = versions->second.lower_bound(txIndex);
+    if (below == versions->second.begin()) {
+      return Result{Status::NOT_FOUND, Version{STORAGE, 0}, ""};
+    }
+    --below;
+    const auto &cell = below->second;
+    if (cell.estimate) {
+      return Result{Status::ESTIMATE, Version{below->first, 0}, ""};
+    }
+    return Result{Status::FOUND, Version{below->first, cell.incarnation},
+                  cell.value};
+  }
+
+  // Returns whether the incarnation wrote a key the previous one did not;
+  // transactions above it that already validated must validate again.
+  bool record(Version version, ReadSet reads, const WriteSet &writes) {
+    for (auto &&write : writes) {
+      auto &shard = shardOf(write.first);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.keys[write.first][version.txIndex] =
+          Cell{version.incarnation, false, write.second};
+    }
+    auto &tx = transactions_[version.txIndex];
+    std::lock_guard<std::mutex> lock(tx.mutex);
+    for (auto &&key : tx.written) {
+      if (writes.count(key) == 0) {
+        removeValue(key, version.txIndex);
+      }
+    }
+    bool wroteNewKey = false;
+    std::unordered_set<std::string> written;
+    for (auto &&write : writes) {
+      wroteNewKey = wroteNewKey || tx.written.count(write.first) == 0;
+      written.insert(write.first);
+    }
+    tx.written = std::move(written);
+    tx.reads = std::move(reads);
+    return wroteNewKey;
+  }
+
+  // Whether every read of the last incarnation would still see the same
+  // version.
+  bool validate(std::size_t txIndex) {
+    auto &tx = transactions_[txIndex];
+    std::lock_guard<std::mutex> lock(tx.mutex);
+    for (auto &&read : tx.reads) {
+      auto current = this->read(read.first, txIndex);
+      if (current.status == Status::ESTIMATE ||
+          !(current.version == read.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void markEstimates(std::size_t txIndex) {
+    auto &tx = transactions_[txIndex];
+    std::lock_guard<std::mutex> lock(tx.mutex);
+    for (auto &&key : tx.written) {
+      auto &shard = shardOf(key);
+      std::lock_guard<std::mutex> shardLock(shard.mutex);
+      shard.keys[key][txIndex].estimate = true;
+    }
+  }
+
+  // Once every transaction has validated: the last value of every key.
+  std::vector<Write> snapshot() {
+    std::vector<Write> writes;
+    for (auto &&shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (auto &&key : shard.keys) {
+        writes.push_back(Write{key.first, key.second.rbegin()->second.value});
+      }
+    }
+    std::sort(writes.begin(), writes.end(),
+              [](const Write &a, const Write &b) { return a.key < b.key; });
+    return writes;
+  }
+
+ private:
+  static constexpr std::size_t SHARDS = 64;
+
+  struct Cell {
+    std::size_t incarnation;
+    bool estimate;
+    std::string value;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::map<std::size_t, Cell>> keys;
+  };
+
+  // Lock order: a transaction's mutex before a shard's.
+  struct TransactionState {
+    std::mutex mutex;
+    std::unordered_set<std::string> written;
+    ReadSet reads;
+  };
+
+  Shard &shardOf(const std::string &key) {
+    return shards_[std::hash<std::string>()(key) % SHARDS];
+  }
+
+  void removeValue(const std::string &key, std::size_t txIndex) {
+    auto &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto versions = shard.keys.find(key);
+    versions->second.erase(txIndex);
+    if (versions->second.empty()) {
+      shard.keys.erase(versions);
+    }
+  }
+
+  std::array<Shard, SHARDS> shards_;
+  std::vector<TransactionState> transactions_;
+};
+
+/**
+ * Hands out execution and validation tasks in block order from two shared
+ * indices. An abort or a newly written key moves the indices back so
+ * that everything above is looked at again; the block is done when both
+ * indices are past its end with no task in flight.
+ */
+class Scheduler {
+ public:
+  enum class Kind { NONE, EXECUTE, VALIDATE };
+
+  struct Task {
+    Kind kind;
+    Version version;
+  };
+
+  explicit Scheduler(std::size_t size) : size_(size), states_(size) {}
+
+  bool done() const { return done_; }
+
+  Task nextTask() {
+    if (validationIndex_ < executionIndex_) {
+      return nextValidation();
+    }
+    return nextExecution();
+  }
+
+  // Suspends txIndex until blocking has executed again; false if it
+  // already has, and the read should simply be retried.
+  bool addDependency(std::size_t txIndex, std::size_t blocking) {
+    std::lock_guard<std::mutex> lock(states_[blocking].mutex);
+    if (states_[blocking].status == Status::EXECUTED) {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> waiting(states_[txIndex].mutex);
+      states_[txIndex].status = Status::ABORTING;
+    }
+    states_[blocking].dependents.push_back(txIndex);
+    activeTasks_--;
+    return true;
+  }
+
+  Task finishExecution(Version version, bool wroteNewKey) {
+    std::vector<std::size_t> dependents;
+    {
+      auto &state = states_[version.txIndex];
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.status = Status::EXECUTED;
+      dependents.swap(state.dependents);
+    }
+    if (!dependents.empty()) {
+      for (auto &&dependent : dependents) {
+        setReady(dependent);
+      }
+      lowerTo(executionIndex_,
+              *std::min_element(dependents.begin(), dependents.end()));
+    }
+    if (validationIndex_ > version.txIndex) {
+      if (!wroteNewKey) {
+        // only this one needs looking at again; keep the task
+        return Task{Kind::VALIDATE, version};
+      }
+      lowerTo(validationIndex_, version.txIndex);
+    }
+    activeTasks_--;
+    return Task{Kind::NONE, version};
+  }
+
+  // Claims the abort of an incarnation; false if another validation
+  // already did or a newer incarnation exists.
+  bool tryAbort(Version version) {
+    auto &state = states_[version.txIndex];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.incarnation == version.incarnation &&
+        state.status == Status::EXECUTED) {
+      state.status = Status::ABORTING;
+      return true;
+    }
+    return false;
+  }
+
+  Task finishValidation(std::size_t txIndex, bool aborted) {
+    if (aborted) {
+      setReady(txIndex);
+      lowerTo(validationIndex_, txIndex + 1);
+      if (executionIndex_ > txIndex) {
+        auto task = tryIncarnate(txIndex);
+        if (task.kind != Kind::NONE) {
+          return task;
+        }
+      }
+    }
+    activeTasks_--;
+    return Task{Kind::NONE, Version{txIndex, 0}};
+  }
+
+ private:
+  enum class Status { READY, EXECUTING, EXECUTED, ABORTING };
+
+  struct State {
+    std::mutex mutex;
+    std::size_t incarnation = 0;
+    Status status = Status::READY;
+    std::vector<std::size_t> dependents;
+  };
+
+  void lowerTo(std::atomic<std::size_t> &index, std::size_t target) {
+    auto current = index.load();
+    while (target < current && !index.compare_exchange_weak(current, target)) {
+    }
+    decreases_++;
+  }
+
+  void setReady(std::size_t txIndex) {
+    auto &state = states_[txIndex];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.incarnation++;
+    state.status = Status::READY;
+  }
+
+  Task tryIncarnate(std::size_t txIndex) {
+    if (txIndex < size_) {
+      auto &state = states_[txIndex];
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (state.status == Status::READY) {
+        state.status = Status::EXECUTING;
+        return Task{Kind::EXECUTE, Version{txIndex, state.incarnation}};
+      }
+    }
+    return Task{Kind::NONE, Version{txIndex, 0}};
+  }
+
+  Task nextExecution() {
+    if (executionIndex_ >= size_) {
+      checkDone();
+      return Task{Kind::NONE, Version{size_, 0}};
+    }
+    activeTasks_++;
+    auto task = tryIncarnate(executionIndex_++);
+    if (task.kind == Kind::NONE) {
+      activeTasks_--;
+    }
+    return task;
+  }
+
+  Task nextValidation() {
+    if (validationIndex_ >= size_) {
+      checkDone();
+      return Task{Kind::NONE, Version{size_, 0}};
+    }
+    activeTasks_++;
+    const auto txIndex = validationIndex_++;
+    if (txIndex < size_) {
+      auto &state = states_[txIndex];
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (state.status == Status::EXECUTED) {
+        return Task{Kind::VALIDATE, Version{txIndex, state.incarnation}};
+      }
+    }
+    activeTasks_--;
+    return Task{Kind::NONE, Version{txIndex, 0}};
+  }
+
+  void checkDone() {
+    const auto observed = decreases_.load();
+    if (std::min(executionIndex_.load(), validationIndex_.load()) >= size_ &&
+        activeTasks_ == 0 && observed == decreases_) {
+      done_ = true;
+    }
+  }
+
+  const std::size_t size_;
+  std::vector<State> states_;
+  std::atomic<std::size_t> executionIndex_{0};
+  std::atomic<std::size_t> validationIndex_{0};
+  std::atomic<std::size_t> decreases_{0};
+  std::atomic<std::size_t> activeTasks_{0};
+  std::atomic<bool> done_{false};
+};
+
+// What one incarnation sees: its own writes, then the block's, then
+// committed state.
+class Incarnation : public Scope {
+ public:
+  Incarnation(MultiVersionMemory &memory, const Read &committed,
+              std::size_t txIndex)
+      : memory_(memory), committed_(committed), txIndex_(txIndex) {}
+
+  std::string find(const std::string &key) override {
+    auto own = writes.find(key);
+    if (own != writes.end()) {
+      return own->second;
+    }
+    auto result = memory_.read(key, txIndex_);
+    switch (result.status) {
+      case MultiVersionMemory::Status::ESTIMATE:
+        throw Dependency{result.version.txIndex};
+      case MultiVersionMemory::Status::NOT_FOUND:
+        result.value = committed_(key);
+        break;
+      case MultiVersionMemory::Status::FOUND:
+        break;
+    }
+    reads.emplace_back(key, result.version);
+    return result.value;
+  }
+
+  void put(const std::string &key, const std::string &value) override {
+    writes[key] = value;
+  }
+
+  void erase(const std::string &key) override { writes[key] = ""; }
+
+  ReadSet reads;
+  WriteSet writes;
+
+ private:
+  MultiVersionMemory &memory_;
+  const Read &committed_;
+  const std::size_t txIndex_;
+};
+
+class Block {
+ public:
+  Block(const std::vector<const Transaction *> &transactions,
+        const Apply &apply, const Read &committed)
+      : transactions_(transactions),
+        apply_(apply),
+        committed_(committed),
+        memory_(transactions.size()),
+        scheduler_(transactions.size()) {}
+
+  void work() {
+    Scheduler::Task task{Scheduler::Kind::NONE, Version{0, 0}};
+    while (!scheduler_.done()) {
+      if (task.kind == Scheduler::Kind::EXECUTE) {
+        task = execute(task.version);
+      }
+      if (task.kind == Scheduler::Kind::VALIDATE) {
+        task = validate(task.version);
+      }
+      if (task.kind == Scheduler::Kind::NONE) {
+        task = scheduler_.nextTask();
+        if (task.kind == Scheduler::Kind::NONE) {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  std::vector<Write> writes() { return memory_.snapshot(); }
+
+ private:
+  Scheduler::Task execute(Version version) {
+    while (true) {
+      Incarnation incarnation(memory_, committed_, version.txIndex);
+      try {
+        ScopeGuard scope(&incarnation);
+        apply_(*transactions_[version.txIndex]);
+      } catch (const Dependency &dependency) {
+        suspensions++;
+        if (scheduler_.addDependency(version.txIndex, dependency.blocking)) {
+          return Scheduler::Task{Scheduler::Kind::NONE, version};
+        }
+        continue;
+      } catch (const std::exception &e) {
+        // as if executed alone: whatever it wrote before failing stands
+        logger::error("block_executor") << e.what();
+      }
+      executions++;
+      const bool wroteNewKey = memory_.record(
+          version, std::move(incarnation.reads), incarnation.writes);
+      return scheduler_.finishExecution(version, wroteNewKey);
+    }
+  }
+
+  Scheduler::Task validate(Version version) {
+    const bool aborted =
+        !memory_.validate(version.txIndex) && scheduler_.tryAbort(version);
+    if (aborted) {
+      aborts++;
+      memory_.markEstimates(version.txIndex);
+    }
+    return scheduler_.finishValidation(version.txIndex, aborted);
+  }
+
+  const std::vector<const Transaction *> &transactions_;
+  const Apply &apply_;
+  const Read &committed_;
+  MultiVersionMemory memory_;
+  Scheduler scheduler_;
+};
+
+std::size_t concurrency() {
+  static const std::size_t threads = [] {
+    auto configured =
+        config::IrohaConfigManager::getInstance().getExecutorConcurrency(0);
+    return configured > 0
+               ? configured
+               : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }();
+  return threads;
+}
+
+ThreadPool &pool() {
+  static ThreadPool instance(ThreadPoolOptions{
+      .threads_count = concurrency(),
+      .worker_queue_size =
+          config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(
+              1024),
+  });
+  return instance;
+}
+
+// Peers and contracts reach beyond world state; they cannot be re-run.
+bool runsAlone(const Transaction &tx) {
+  std::string type = tx.type();
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  return tx.has_peer() || type == "contract";
+}
+
+
+// Transfers in and out of one account (an exchange's hot wallet) all
+// conflict; run optimistically they would mostly be run again.
+bool hasHotAccount(const std::vector<const Transaction *> &block) {
+  static const std::size_t percent =
+      config::IrohaConfigManager::getInstance().getExecutorHotAccountPercent(
+          25);
+  std::unordered_map<std::string, std::size_t> touches;
+  const auto touch = [&](const std::string &key) {
+    // a transaction without a receiver touches no second account
+    return !key.empty() && ++touches[key] * 100 >= percent * block.size();
+  };
+  for (auto &&tx : block) {
+    if (touch(tx->senderpubkey())) {
+      return true;
+    }
+    if (tx->receivepubkey() != tx->senderpubkey() &&
+        touch(tx->receivepubkey())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Keeps assets decoded across the whole run, so a hot account is parsed
+// and serialised once rather than once per transaction.
+void executeSerially(const std::vector<const Transaction *> &block) {
+  if (block.empty()) {
+    return;
+  }
+  repository::asset::BlockTable table;
+  for (auto &&tx : block) {
+    executor::execute(*tx);
+  }
+  table.flush();
+}
+
+void executeInParallel(const std::vector<const Transaction *> &block) {
+  if (block.size() < 2 || concurrency() < 2 || hasHotAccount(block)) {
+    executeSerially(block);
+    return;
+  }
+  // workers read what the calling thread reads, e.g. a block overlay
+  auto outer = repository::world_state_repository::currentScope();
+  const Read committed = [outer](const std::string &key) {
+    ScopeGuard scope(outer);
+    return repository::world_state_repository::find(key);
+  };
+  std::vector<std::tuple<std::string, std::string>> puts;
+  for (auto &&write : run(block, executor::execute, committed, concurrency())) {
+    if (write.value.empty()) {
+      repository::world_state_repository::remove(write.key);
+    } else {
+      puts.emplace_back(write.key, write.value);
+    }
+  }
+  if (!puts.empty()) {
+    repository::world_state_repository::addBatch<std::string>(puts);
+  }
+}
+
+}  // namespace detail
+
+std::vector<Write> run(const std::vector<const Transaction *> &block,
+                       const Apply &apply, const Read &read,
+                       std::size_t threads) {
+  detail::Block state(block, apply, read);
+  std::vector<std::future<void>> helpers;
+  try {
+    for (std::size_t i = 1; i < std::min(threads, block.size()); i++) {
+      helpers.push_back(detail::pool().process([&state] { state.work(); }));
+    }
+  } catch (const std::exception &e) {
+    // fewer helpers only means less parallelism
+    logger::warning("block_executor") << e.what();
+  }
+  state.work();
+  for (auto &&helper : helpers) {
+    helper.wait();
+  }
+  detail::blocks++;
+  detail::transactions += block.size();
+  return state.writes();
+}
+
+void execute(const std::vector<const Transaction *> &block) {
+  std::vector<const Transaction *> segment;
+  for (auto &&tx : block) {
+    if (detail::runsAlone(*tx)) {
+      detail::executeInParallel(segment);
+      segment.clear();
+      executor::execute(*tx);
+    } else {
+      segment.push_back(tx);
+    }
+  }
+  detail::executeInParallel(segment);
+}
+
+Stats stats() {
+  return Stats{detail::blocks.load(), detail::transactions.load(),
+               detail::executions.load(), detail::aborts.load(),
+               detail::suspensions.load()};
+}
+
+};  // namespace block_executor
@@ -0,0 +1,73 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_SERVICE_BLOCK_EXECUTOR_HPP_
+#define CORE_SERVICE_BLOCK_EXECUTOR_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+/**
+ * Executes a committed block with Block-STM: transactions run speculatively
+ * on worker threads against a multi-version overlay of world state, their
+ * read sets are validated against the versions that precede them in the
+ * block, and those that read something a lower transaction rewrote run
+ * again. The outcome is exactly that of executing the block in order.
+ */
+namespace block_executor {
+
+using Api::Transaction;
+
+// Runs one transaction; reads and writes go through world_state_repository.
+using Apply = std::function<void(const Transaction &)>;
+// The committed value of a key, empty if absent.
+using Read = std::function<std::string(const std::string &)>;
+
+struct Write {
+  std::string key;
+  std::string value;  // empty: the key is removed
+};
+
+struct Stats {
+  std::uint64_t blocks;
+  std::uint64_t transactions;
+  std::uint64_t executions;  // incarnations, re-executions included
+  std::uint64_t aborts;      // incarnations that failed validation
+  std::uint64_t suspensions; // reads that waited on a pending write
+};
+
+// Executes block in parallel on up to threads threads and returns, ordered
+// by key, the writes serial execution would have made. Nothing is written.
+std::vector<Write> run(const std::vector<const Transaction *> &block,
+                       const Apply &apply, const Read &read,
+                       std::size_t threads);
+
+// Executes block with executor::execute and writes the result to world
+// state. Transactions with effects beyond world state (peers, contracts)
+// run serially in their place, between parallel runs of the others. A run
+// dominated by one account is executed serially with its assets kept
+// decoded, see repository::asset::BlockTable.
+void execute(const std::vector<const Transaction *> &block);
+
+Stats stats();
+
+};  // namespace block_executor
+
+#endif  // CORE_SERVICE_BLOCK_EXECUTOR_HPP_
@@ -86,9 +86,14 @@ namespace executor{
                 percent != tx.asset().value().end() &&
                 value != tx.asset().value().end()
             ) {
-                auto senderAsset = repository::asset::find(sender, assetName);
-                auto authorAsset = repository::asset::find((*author).second.valuestring(), assetName);
-                auto receiverAsset = repository::asset::find(receiver, assetName);
+                auto assets = repository::asset::findMany({
+                    {sender, assetName},
+                    {(*author).second.valuestring(), assetName},
+                    {receiver, assetName}
+                });
+                auto senderAsset = assets[0];
+                auto authorAsset = assets[1];
+                auto receiverAsset = assets[2];
 
                 if(!senderAsset.name().empty() &&
                    !authorAsset.name().empty() &&
@@ -153,8 +158,9 @@ namespace executor{
             if (targetName != tx.asset().value().end() &&
                 value != tx.asset().value().end()
             ) {
-                auto senderAsset    = repository::asset::find(sender, assetName);
-                auto receiverAsset  = repository::asset::find(receiver, assetName);
+                auto assets = repository::asset::findMany({{sender, assetName}, {receiver, assetName}});
+                auto senderAsset    = assets[0];
+                auto receiverAsset  = assets[1];
                 if(
                    !senderAsset.name().empty() &&
                    !receiverAsset.name().empty()
@@ -199,8 +205,9 @@ namespace executor{
             if (
                 value != tx.asset().value().end()
             ) {
-                auto senderAsset = repository::asset::find(sender, assetName);
-                auto receiverAsset = repository::asset::find(receiver, assetName);
+                auto assets = repository::asset::findMany({{sender, assetName}, {receiver, assetName}});
+                auto senderAsset = assets[0];
+                auto receiverAsset = assets[1];
                 if (
                     !senderAsset.name().empty() &&
                     !receiverAsset.name().empty()
@@ -17,18 +17,55 @@ limitations under the License.
 // Created by Takumi Yamashita on 2017/03/16.
 //
 
+#include <exception>
+#include <map>
+#include <mutex>
+
 #include <service/peer_service.hpp>
 #include <service/hijiri.hpp>
 #include <consensus/connection/connection.hpp>
+#include <util/logger.hpp>
+#include <util/timer_wheel.hpp>
 
 namespace peer {
 namespace hijiri {
 
+namespace detail {
+std::mutex mutex;
+std::map<std::string, timer::TimerId> checks;
+
+void scheduleCheck(const std::string &ip, int intervalMillis,
+                   const Dispatch &dispatch) {
+  auto id = timer::schedule(
+      std::chrono::milliseconds(intervalMillis),
+      [ip, intervalMillis, dispatch]() {
+        auto next = [ip, intervalMillis, dispatch]() {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (checks.count(ip)) {
+            scheduleCheck(ip, intervalMillis, dispatch);
+          }
+        };
+        try {
+          dispatch([ip, next]() {
+            check(ip);
+            next();
+          });
+        } catch (const std::exception &e) {
+          // the pool is full; skip this check rather than block the wheel
+          logger::warning("hijiri") << "skipped checking " << ip << ": "
+                                    << e.what();
+          next();
+        }
+      });
+  checks[ip] = id;
+}
+}
+
 // check are broken? peer
 void check(const std::string &ip) {
-  if (!service::isExistIP(ip))
+  auto check_peer_it = service::getPeerSet()->findIp(ip);
+  if (check_peer_it == nullptr)
     return;
-  auto check_peer_it = *service::findPeerIP(ip);
   if (!connection::iroha::PeerService::Sumeragi::ping(ip)) {
     if (check_peer_it->trustScore < 0.0) {
       transaction::isssue::remove(check_peer_it->publicKey);
@@ -40,6 +77,24 @@ void check(const std::string &ip) {
   }
 }
 
+void startCheck(const std::string &ip, int intervalMillis, Dispatch dispatch) {
+  std::lock_guard<std::mutex> lock(detail::mutex);
+  if (detail::checks.count(ip)) {
+    return; // already being checked
+  }
+  detail::scheduleCheck(ip, intervalMillis, dispatch);
+}
+
+void stopCheck(const std::string &ip) {
+  std::lock_guard<std::mutex> lock(detail::mutex);
+  auto found = detail::checks.find(ip);
+  if (found == detail::checks.end()) {
+    return;
+  }
+  timer::cancel(found->second);
+  detail::checks.erase(found);
+}
+
 } // namespace hijiri
 } // namespace peer
 
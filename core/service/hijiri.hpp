@@ -17,9 +17,11 @@ limitations under the License.
 #ifndef __CORE_HIJIRI_SERVICE_HPP__
 #define __CORE_HIJIRI_SERVICE_HPP__
 
+#include <functional>
 #include <map>
 #include <queue>
 #include <set>
+#include <string>
 #include <vector>
 
 namespace peer {
@@ -30,6 +32,13 @@ namespace hijiri {
 void check(
     const std::string &ip); // void checkBrokenPeer(const std::string &ip);
                             // [WIPn] does we need it? void checkAll();
+
+// ping blocks on gRPC, so the timer hands each check to the caller's pool
+using Dispatch = std::function<void(std::function<void()>)>;
+
+// check the peer every intervalMillis until stopCheck(ip) is called
+void startCheck(const std::string &ip, int intervalMillis, Dispatch dispatch);
+void stopCheck(const std::string &ip);
 }
 }
 
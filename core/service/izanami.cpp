@@ -24,18 +24,27 @@ limitations under the License.
 #include <service/peer_service.hpp>
 #include <string>
 #include <thread_pool.hpp>
+#include <util/timer_wheel.hpp>
 #include <vector>
 
 namespace peer {
 namespace izanami {
 using Api::TransactionResponse;
 
-void setAwkTimer(int const sleepMillisecs,
-                 const std::function<void(void)> &action) {
-  std::thread([action, sleepMillisecs]() {
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMillisecs));
-    action();
-  }).join();
+static ThreadPool pool(ThreadPoolOptions{
+    .threads_count =
+        config::IrohaConfigManager::getInstance().getConcurrency(0),
+    .worker_queue_size =
+        config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
+});
+
+// The action is sent over gRPC, so it runs on the pool, not the timer thread.
+timer::TimerId setAwkTimer(int const sleepMillisecs,
+                           const std::function<void(void)> &action) {
+  return timer::schedule(std::chrono::milliseconds(sleepMillisecs), [action]() {
+    std::function<void()> task = action;
+    pool.process(std::move(task));
+  });
 }
 
 InitializeEvent::InitializeEvent() {
@@ -183,21 +192,12 @@ void receiveTransactionResponse(TransactionResponse &txResponse) {
     }
   }
   if (!event.isFinished() && txResponse.transaction().empty())
-    setAwkTimer(1000, [&txResponse]() {
+    setAwkTimer(1000, [txResponse]() {
       connection::iroha::PeerService::Izanami::send(::peer::myself::getIp(),
                                                     txResponse);
     });
 }
 
-static ThreadPool pool(ThreadPoolOptions{
-    .threads_count =
-        config::IrohaConfigManager::getInstance().getConcurrency(0),
-    .worker_queue_size =
-        config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
-}
-
-                       );
-
 // invoke when initialize Peer that to config Participation on the way
 void startIzanami() {
   logger::explore("izanami") << "startIzanami";
@@ -17,6 +17,7 @@ limitations under the License.
 #include <infra/protobuf/api.pb.h>
 #include <memory>
 #include <string>
+#include <util/timer_wheel.hpp>
 #include <vector>
 
 namespace peer {
@@ -72,8 +73,8 @@ void receiveTransactionResponse(TransactionResponse &);
 // invoke when initialize Peer that to config Participation on the way
 void startIzanami();
 
-void setAwkTimer(int const sleepMillisecs,
-                 const std::function<void(void)> &action);
+timer::TimerId setAwkTimer(int const sleepMillisecs,
+                           const std::function<void(void)> &action);
 }
 }
 
@@ -20,10 +20,13 @@ limitations under the License.
 //
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <mutex>
 #include <regex>
 
 #include <consensus/connection/connection.hpp>
+#include <crypto/hash.hpp>
 #include <infra/config/peer_service_with_json.hpp>
 #include <repository/transaction_repository.hpp>
 #include <service/peer_service.hpp>
@@ -43,6 +46,59 @@ using type_signatures::Peer;
 Nodes peerList;
 bool is_active;
 
+namespace detail {
+// serializes changes to peerList and the publication of its snapshots
+std::mutex writeMutex;
+std::once_flag initialized;
+std::shared_ptr<const PeerSet> current = std::make_shared<PeerSet>();
+std::uint64_t lastGeneration = 0;
+
+// Caller holds writeMutex.
+void publish() {
+  auto next = std::make_shared<PeerSet>();
+  next->generation = ++lastGeneration;
+  for (const auto &node : peerList) {
+    auto copy = std::make_shared<Node>(*node);
+    next->byIp[copy->ip] = copy;
+    next->byPublicKey[copy->publicKey] = copy;
+    if (copy->isok) {
+      next->nodes.push_back(copy);
+    }
+  }
+  std::stable_sort(next->nodes.begin(), next->nodes.end(),
+                   [](const auto &a, const auto &b) {
+                     return a->trustScore > b->trustScore;
+                   });
+  std::string keys;
+  for (const auto &node : next->nodes) {
+    next->ips.push_back(node->ip);
+    next->signers.push_back(node->publicKey);
+  }
+  std::sort(next->signers.begin(), next->signers.end());
+  for (const auto &publicKey : next->signers) {
+    keys += publicKey + "\n";
+  }
+  next->version = std::stoull(hash::sha3_256_hex(keys).substr(0, 16), nullptr, 16);
+  next->maxFaulty = std::max(0, ((int)next->nodes.size() - 1) / 3);
+  std::atomic_store(&current, std::shared_ptr<const PeerSet>(std::move(next)));
+}
+} // namespace detail
+
+std::shared_ptr<Node> PeerSet::findIp(const std::string &ip) const {
+  auto found = byIp.find(ip);
+  return found == byIp.end() ? nullptr : found->second;
+}
+
+std::shared_ptr<Node> PeerSet::findPublicKey(const std::string &publicKey) const {
+  auto found = byPublicKey.find(publicKey);
+  return found == byPublicKey.end() ? nullptr : found->second;
+}
+
+bool PeerSet::isActiveIp(const std::string &ip) const {
+  auto node = findIp(ip);
+  return node != nullptr && node->isok;
+}
+
 namespace myself {
 
 std::string getPublicKey() {
@@ -65,10 +121,10 @@ void activate() { is_active = true; }
 void stop() { is_active = false; }
 
 bool isLeader() {
-  auto sorted_peers = service::getPeerList();
-  if (sorted_peers.empty())
+  auto peers = service::getPeerSet();
+  if (peers->nodes.empty())
     return false;
-  auto peer = *sorted_peers.begin();
+  const auto &peer = peers->nodes.front();
   return peer->publicKey == getPublicKey() &&
          peer->ip == getIp();
 }
@@ -79,55 +135,36 @@ namespace service {
 
 // this function must be invoke before use peer-service.
 void initialize() {
-  if (!peerList.empty()) {
-    return;
-  }
-  for (const auto &json_peer : PeerServiceConfig::getInstance().getGroup()) {
-    peerList.push_back(std::make_shared<Node>(
-        json_peer["ip"].get<std::string>(),
-        json_peer["publicKey"].get<std::string>(),
-        PeerServiceConfig::getInstance().getMaxTrustScore()));
-  }
-}
-
-size_t getMaxFaulty() {
-  return std::max(0, ((int)getPeerList().size() - 1) / 3);
+  std::call_once(detail::initialized, [] {
+    std::lock_guard<std::mutex> lock(detail::writeMutex);
+    for (const auto &json_peer : PeerServiceConfig::getInstance().getGroup()) {
+      peerList.push_back(std::make_shared<Node>(
+          json_peer["ip"].get<std::string>(),
+          json_peer["publicKey"].get<std::string>(),
+          PeerServiceConfig::getInstance().getMaxTrustScore()));
+    }
+    detail::publish();
+  });
 }
 
-Nodes getPeerList() {
+std::shared_ptr<const PeerSet> getPeerSet() {
   initialize();
+  return std::atomic_load(&detail::current);
+}
 
-  Nodes nodes;
-  for (const auto &node : peerList) {
-    if (node->isok) {
-      nodes.push_back(std::make_unique<peer::Node>(
-          node->ip, node->publicKey, node->trustScore));
-    }
-  }
-
-  // TODO: maintain nodes already sorted
-  sort(nodes.begin(), nodes.end(), [](const auto &a, const auto &b) {
-    return a->trustScore > b->trustScore;
-  });
+size_t getMaxFaulty() { return getPeerSet()->maxFaulty; }
 
-  return nodes;
-}
+Nodes getPeerList() { return getPeerSet()->nodes; }
 
-std::vector<std::string> getIpList() {
-  std::vector<std::string> ret_ips;
-  for (const auto &node : getPeerList()) {
-    ret_ips.push_back(node->ip);
-  }
-  return ret_ips;
-}
+std::vector<std::string> getIpList() { return getPeerSet()->ips; }
 
 // is exist which peer?
 bool isExistIP(const std::string &ip) {
-  return findPeerIP(std::move(ip)) != peerList.end();
+  return getPeerSet()->findIp(ip) != nullptr;
 }
 
 bool isExistPublicKey(const std::string &publicKey) {
-  return findPeerPublicKey(std::move(publicKey)) != peerList.end();
+  return getPeerSet()->findPublicKey(publicKey) != nullptr;
 }
 
 Nodes::iterator findPeerIP(const std::string &ip) {
@@ -144,7 +181,7 @@ Nodes::iterator findPeerPublicKey(const std::string &publicKey) {
 }
 
 std::shared_ptr<peer::Node> leaderPeer() {
-  return std::move(*getPeerList().begin());
+  return getPeerSet()->nodes.front();
 }
 
 } // namespace service
@@ -168,7 +205,8 @@ void finished() {
 bool start(const Node &peer) {
   logger::debug("peer-service") << "in sendAllTransactionToNewPeer";
   // when my node is not active, it don't send data.
-  if (!(*service::findPeerPublicKey(myself::getPublicKey()))->isok) {
+  auto me = service::getPeerSet()->findPublicKey(myself::getPublicKey());
+  if (me == nullptr || !me->isok) {
     return false;
   }
 
@@ -176,11 +214,11 @@ bool start(const Node &peer) {
   { // Send PeerList data ( Reason: Can't do to construct peerList for only
     // transaction infomation. )
     logger::debug("peer-service") << "send all peer infomation";
-    auto sorted_peerList = service::getPeerList();
+    auto peers = service::getPeerSet();
     auto txResponse = Api::TransactionResponse();
     txResponse.set_message("Initilize send now Active PeerList info");
     txResponse.set_code(code++);
-    for (auto &&peer : sorted_peerList) {
+    for (auto &&peer : peers->nodes) {
       auto txPeer =
           TransactionBuilder<Add<Peer>>()
               .setSenderPublicKey(myself::getPublicKey())
@@ -200,19 +238,22 @@ bool start(const Node &peer) {
   if (0) { // WIP(leveldb don't active) Send transaction data separated block to
            // new peer.
     logger::debug("peer-service") << "send all transaction infomation";
-    auto transactions = repository::transaction::findAll();
+    // one block in memory at a time, however long the ledger
     std::size_t block_size = 500;
-    for (std::size_t i = 0; i < transactions.size(); i += block_size) {
+    std::string resumeToken;
+    do {
+      auto page = repository::transaction::findPage(resumeToken, block_size);
+      resumeToken = page.resumeToken;
       auto txResponse = Api::TransactionResponse();
       txResponse.set_message("Midstream send Transactions");
       txResponse.set_code(code++);
-      for (std::size_t j = i; j < i + block_size; j++) {
-        txResponse.add_transaction()->CopyFrom(transactions[j]);
+      for (auto &&tx : page.transactions) {
+        *txResponse.add_transaction() = std::move(tx);
       }
       if (!connection::iroha::PeerService::Izanami::send(peer.ip,
                                                          txResponse))
         return false;
-    }
+    } while (!resumeToken.empty());
   }
 
   { // end-point
@@ -273,9 +314,10 @@ void remove(const std::string &publicKey) {
                                                  txPeer);
 }
 void credit(const std::string &publicKey) {
-  if (!service::isExistPublicKey(publicKey))
+  auto peer = service::getPeerSet()->findPublicKey(publicKey);
+  if (peer == nullptr)
     return;
-  if ((*service::findPeerPublicKey(publicKey))->trustScore ==
+  if (peer->trustScore ==
       PeerServiceConfig::getInstance().getMaxTrustScore()) {
     return;
   }
@@ -292,6 +334,8 @@ void credit(const std::string &publicKey) {
 namespace executor {
 // invoke when execute transaction
 bool add(const peer::Node &peer) {
+  service::initialize();
+  std::lock_guard<std::mutex> lock(detail::writeMutex);
   try {
     if (service::isExistIP(peer.ip))
       throw exception::service::DuplicationIPException(peer.ip);
@@ -299,6 +343,7 @@ bool add(const peer::Node &peer) {
       throw exception::service::DuplicationPublicKeyException(
           peer.publicKey);
     peerList.emplace_back(std::make_shared<peer::Node>(peer));
+    detail::publish();
   } catch (exception::service::DuplicationPublicKeyException &e) {
     logger::warning("addPeer") << e.what();
     return false;
@@ -309,11 +354,14 @@ bool add(const peer::Node &peer) {
   return true;
 }
 bool remove(const std::string &publicKey) {
+  service::initialize();
+  std::lock_guard<std::mutex> lock(detail::writeMutex);
   try {
     auto it = service::findPeerPublicKey(publicKey);
-    if (!service::isExistPublicKey(publicKey))
+    if (it == peerList.end())
       throw exception::service::UnExistFindPeerException(publicKey);
     peerList.erase(it);
+    detail::publish();
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("removePeer") << e.what();
     return false;
@@ -321,6 +369,8 @@ bool remove(const std::string &publicKey) {
   return true;
 }
 bool update(const std::string &publicKey, const peer::Node &peer) {
+  service::initialize();
+  std::lock_guard<std::mutex> lock(detail::writeMutex);
   try {
     auto it = service::findPeerPublicKey(publicKey);
     if (it == peerList.end())
@@ -350,6 +400,7 @@ bool update(const std::string &publicKey, const peer::Node &peer) {
     if (pk->isok != peer.isok) {
       pk->isok = peer.isok;
     }
+    detail::publish();
 
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("updatePeer") << e.what();
@@ -359,6 +410,8 @@ bool update(const std::string &publicKey, const peer::Node &peer) {
     return false;
   } catch (exception::service::DuplicationIPException &e) {
     logger::warning("updatePeer") << e.what();
+    // the public key may already have been changed
+    detail::publish();
     return false;
   }
   return true;
@@ -395,20 +448,21 @@ bool remove(const std::string &publicKey) {
 }
 bool update(const std::string &publicKey, const peer::Node &peer) {
   try {
-    auto it = service::findPeerPublicKey(publicKey);
-    if (it == peerList.end())
+    auto peers = service::getPeerSet();
+    auto target = peers->findPublicKey(publicKey);
+    if (target == nullptr)
       throw exception::service::UnExistFindPeerException(publicKey);
 
-    if (!(*it)->isDefaultPubKey()) {
-      auto upd_it = service::findPeerPublicKey(peer.publicKey);
-      if (upd_it != it && upd_it != peerList.end())
+    if (!target->isDefaultPubKey()) {
+      auto other = peers->findPublicKey(peer.publicKey);
+      if (other != target && other != nullptr)
         throw exception::service::DuplicationPublicKeyException(
             peer.publicKey);
     }
 
     if (!peer.isDefaultIP()) {
-      auto upd_it = service::findPeerIP(peer.ip);
-      if (upd_it != it && upd_it != peerList.end())
+      auto other = peers->findIp(peer.ip);
+      if (other != target && other != nullptr)
         throw exception::service::DuplicationIPException(peer.ip);
     }
 
@@ -17,8 +17,10 @@ limitations under the License.
 #ifndef __CORE_PEER_SERVICE_HPP__
 #define __CORE_PEER_SERVICE_HPP__
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace peer {
@@ -42,6 +44,30 @@ struct Node {
 
 using Nodes = std::vector<std::shared_ptr<Node>>;
 
+// Immutable view of the peer list. A new one is published whenever the list
+// changes, so readers neither lock nor see it change under them. Its nodes
+// are shared by every reader and must be treated as read-only.
+struct PeerSet {
+  // Derived from the public keys of nodes, so every peer with the same
+  // validators has the same version; trust changes leave it alone.
+  std::uint64_t version = 0;
+  // Counts every publication on this peer; only for local caches.
+  std::uint64_t generation = 0;
+  Nodes nodes;                  // active peers, highest trust first
+  std::vector<std::string> ips; // of nodes, in the same order
+  // Public keys of nodes in ascending order. A signer index, which every
+  // peer has to agree on, is a position in here rather than in nodes.
+  std::vector<std::string> signers;
+  std::size_t maxFaulty = 0;
+  // every peer, active or not
+  std::unordered_map<std::string, std::shared_ptr<Node>> byIp;
+  std::unordered_map<std::string, std::shared_ptr<Node>> byPublicKey;
+
+  std::shared_ptr<Node> findIp(const std::string &ip) const;
+  std::shared_ptr<Node> findPublicKey(const std::string &publicKey) const;
+  bool isActiveIp(const std::string &ip) const;
+};
+
 namespace myself {
 
 std::string getPublicKey();
@@ -61,6 +87,8 @@ namespace service {
 
 void initialize();
 
+std::shared_ptr<const PeerSet> getPeerSet();
+
 size_t getMaxFaulty();
 Nodes getPeerList();
 std::vector<std::string> getIpList();
@@ -69,6 +97,8 @@ std::vector<std::string> getIpList();
 bool isExistIP(const std::string &);
 bool isExistPublicKey(const std::string &);
 
+// These walk the mutable list and are meant for transaction::executor;
+// everyone else should look peers up in getPeerSet().
 Nodes::iterator findPeerIP(const std::string &ip);
 Nodes::iterator findPeerPublicKey(const std::string &publicKey);
 std::shared_ptr<peer::Node> leader();
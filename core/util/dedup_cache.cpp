@@ -0,0 +1,197 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "dedup_cache.hpp"
+
+namespace dedup {
+
+namespace detail {
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+std::uint32_t word(const Digest &digest, std::size_t offset) {
+  std::uint32_t w;
+  std::memcpy(&w, digest.data() + offset, sizeof(w));
+  return w;
+}
+}
+
+Digest fromHex(const std::string &hex) {
+  Digest digest;
+  if (hex.size() != digest.size() * 2) {
+    throw std::invalid_argument("not a sha3-256 hex digest: " + hex);
+  }
+  for (std::size_t i = 0; i < digest.size(); i++) {
+    auto high = detail::hexValue(hex[2 * i]);
+    auto low = detail::hexValue(hex[2 * i + 1]);
+    if (high < 0 || low < 0) {
+      throw std::invalid_argument("not a sha3-256 hex digest: " + hex);
+    }
+    digest[i] = static_cast<std::uint8_t>(high << 4 | low);
+  }
+  return digest;
+}
+
+DedupCache::DedupCache(std::size_t capacity, std::size_t shards,
+                       std::size_t bloomCounters)
+    : shardCapacity_(std::max<std::size_t>(
+          1, capacity / std::max<std::size_t>(1, shards))),
+      bloom_(bloomCounters) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(1, shards); i++) {
+    shards_.emplace_back(new Shard);
+  }
+  for (auto &counter : bloom_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+bool DedupCache::insert(const Digest &digest, std::uint64_t order) {
+  lookups_++;
+  auto &shard = shardOf(digest);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.orders.count(digest)) {
+    hits_++;
+    return false;
+  }
+  // added to the filter first, so contains() never misses a stored digest
+  bloomAdd(digest);
+  shard.orders.emplace(digest, order);
+  shard.byOrder[order].push_back(digest);
+  inserts_++;
+  while (shard.orders.size() > shardCapacity_) {
+    evictOldest(shard);
+  }
+  return true;
+}
+
+bool DedupCache::contains(const Digest &digest) {
+  lookups_++;
+  if (!bloomMayContain(digest)) {
+    bloomRejects_++;
+    return false;
+  }
+  auto &shard = shardOf(digest);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.orders.count(digest)) {
+    hits_++;
+    return true;
+  }
+  return false;
+}
+
+void DedupCache::evictBefore(std::uint64_t order) {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    while (!shard->byOrder.empty() && shard->byOrder.begin()->first < order) {
+      eraseRound(*shard, shard->byOrder.begin());
+    }
+  }
+}
+
+Stats DedupCache::stats() {
+  std::size_t size = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    size += shard->orders.size();
+  }
+  // one hash node and one round entry per digest
+  const std::size_t perEntry =
+      2 * sizeof(Digest) + sizeof(std::uint64_t) + 2 * sizeof(void *);
+  return Stats{size,
+               size * perEntry + bloom_.size(),
+               lookups_.load(),
+               hits_.load(),
+               inserts_.load(),
+               evictions_.load(),
+               bloomRejects_.load()};
+}
+
+DedupCache::Shard &DedupCache::shardOf(const Digest &digest) {
+  return *shards_[detail::word(digest, 8) % shards_.size()];
+}
+
+void DedupCache::evictOldest(Shard &shard) {
+  auto oldest = shard.byOrder.begin();
+  auto &digests = oldest->second;
+  shard.orders.erase(digests.back());
+  bloomRemove(digests.back());
+  digests.pop_back();
+  evictions_++;
+  if (digests.empty()) {
+    shard.byOrder.erase(oldest);
+  }
+}
+
+void DedupCache::eraseRound(
+    Shard &shard, std::map<std::uint64_t, std::vector<Digest>>::iterator round) {
+  for (auto &&digest : round->second) {
+    shard.orders.erase(digest);
+    bloomRemove(digest);
+    evictions_++;
+  }
+  shard.byOrder.erase(round);
+}
+
+bool DedupCache::bloomMayContain(const Digest &digest) const {
+  if (bloom_.empty()) {
+    return true;
+  }
+  for (std::size_t i = 0; i < BLOOM_HASHES; i++) {
+    auto &counter = bloom_[detail::word(digest, 16 + 4 * i) % bloom_.size()];
+    if (counter.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DedupCache::bloomAdd(const Digest &digest) {
+  if (bloom_.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < BLOOM_HASHES; i++) {
+    auto &counter = bloom_[detail::word(digest, 16 + 4 * i) % bloom_.size()];
+    auto value = counter.load(std::memory_order_relaxed);
+    // a saturated counter stays saturated; it can no longer be decremented
+    while (value != UINT8_MAX &&
+           !counter.compare_exchange_weak(value, value + 1,
+                                          std::memory_order_relaxed)) {
+    }
+  }
+}
+
+void DedupCache::bloomRemove(const Digest &digest) {
+  if (bloom_.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < BLOOM_HASHES; i++) {
+    auto &counter = bloom_[detail::word(digest, 16 + 4 * i) % bloom_.size()];
+    auto value = counter.load(std::memory_order_relaxed);
+    while (value != UINT8_MAX && value != 0 &&
+           !counter.compare_exchange_weak(value, value - 1,
+                                          std::memory_order_relaxed)) {
+    }
+  }
+}
+
+}  // namespace dedup
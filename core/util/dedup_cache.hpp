@@ -0,0 +1,119 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __DEDUP_CACHE_HPP_
+#define __DEDUP_CACHE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dedup {
+
+using Digest = std::array<std::uint8_t, 32>;
+
+// Parses a 64 character sha3-256 hex digest; throws std::invalid_argument.
+Digest fromHex(const std::string &hex);
+
+struct Stats {
+  std::size_t size;
+  std::size_t approximateBytes;
+  std::uint64_t lookups;
+  std::uint64_t hits;
+  std::uint64_t inserts;
+  std::uint64_t evictions;
+  // lookups answered by the Bloom filter without taking a shard lock
+  std::uint64_t bloomRejects;
+};
+
+/**
+ * Set of recently committed transaction digests, tagged with the round
+ * (order) that committed them.
+ *
+ * Digests are spread over independently locked shards. Each shard is bounded
+ * by count and drops its oldest rounds first; evictBefore() drops whole
+ * rounds once they are old enough that a replay can no longer reach
+ * consensus. An optional counting Bloom filter answers most misses without
+ * touching a shard.
+ */
+class DedupCache {
+ public:
+  // bloomCounters is the size of the counting Bloom filter, one byte each;
+  // 0 disables it.
+  DedupCache(std::size_t capacity, std::size_t shards,
+             std::size_t bloomCounters);
+
+  DedupCache(const DedupCache &) = delete;
+  DedupCache &operator=(const DedupCache &) = delete;
+
+  // Returns false if the digest was already there.
+  bool insert(const Digest &digest, std::uint64_t order);
+  bool contains(const Digest &digest);
+
+  // Drops every digest committed in a round before order.
+  void evictBefore(std::uint64_t order);
+
+  Stats stats();
+
+ private:
+  struct DigestHash {
+    std::size_t operator()(const Digest &digest) const {
+      // the digest is already uniformly distributed
+      std::size_t h;
+      std::memcpy(&h, digest.data(), sizeof(h));
+      return h;
+    }
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<Digest, std::uint64_t, DigestHash> orders;
+    std::map<std::uint64_t, std::vector<Digest>> byOrder;
+  };
+
+  Shard &shardOf(const Digest &digest);
+  void evictOldest(Shard &shard);
+  void eraseRound(Shard &shard,
+                  std::map<std::uint64_t, std::vector<Digest>>::iterator round);
+
+  bool bloomMayContain(const Digest &digest) const;
+  void bloomAdd(const Digest &digest);
+  void bloomRemove(const Digest &digest);
+
+  static constexpr std::size_t BLOOM_HASHES = 4;
+
+  const std::size_t shardCapacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  // saturating counters, so evicted digests can be taken out again
+  std::vector<std::atomic<std::uint8_t>> bloom_;
+
+  std::atomic<std::uint64_t> lookups_{0};
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> inserts_{0};
+  std::atomic<std::uint64_t> evictions_{0};
+  std::atomic<std::uint64_t> bloomRejects_{0};
+};
+
+}  // namespace dedup
+
+#endif
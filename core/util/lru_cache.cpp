@@ -0,0 +1,122 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <functional>
+
+#include "lru_cache.hpp"
+
+namespace lru {
+
+ShardedCache::ShardedCache(std::size_t capacityBytes, std::size_t shards)
+    : shardCapacity_(capacityBytes / std::max<std::size_t>(1, shards)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(1, shards); i++) {
+    shards_.emplace_back(new Shard);
+  }
+}
+
+// what a node of the list and the index cost on top of the strings
+std::size_t ShardedCache::cost(const std::string &key,
+                               const std::string &value) {
+  return 2 * key.size() + value.size() + 96;
+}
+
+ShardedCache::Shard &ShardedCache::shardOf(const std::string &key) {
+  return *shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+bool ShardedCache::get(const std::string &key, std::string &value) {
+  auto &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it == shard.index.end()) {
+    misses_++;
+    return false;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  value = it->second->second;
+  hits_++;
+  return true;
+}
+
+std::uint64_t ShardedCache::generation(const std::string &key) {
+  auto &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.generation;
+}
+
+void ShardedCache::fill(const std::string &key, const std::string &value,
+                        std::uint64_t generation) {
+  auto &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.generation == generation) {
+    store(shard, key, value);
+  }
+}
+
+void ShardedCache::put(const std::string &key, const std::string &value) {
+  auto &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.generation++;
+  store(shard, key, value);
+}
+
+void ShardedCache::erase(const std::string &key) {
+  auto &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.generation++;
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    drop(shard, it->second);
+  }
+}
+
+void ShardedCache::store(Shard &shard, const std::string &key,
+                         const std::string &value) {
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    drop(shard, it->second);
+  }
+  const auto bytes = cost(key, value);
+  if (bytes > shardCapacity_) {
+    return;
+  }
+  while (shard.bytes + bytes > shardCapacity_) {
+    drop(shard, std::prev(shard.entries.end()));
+    evictions_++;
+  }
+  shard.entries.emplace_front(key, value);
+  shard.index[key] = shard.entries.begin();
+  shard.bytes += bytes;
+}
+
+void ShardedCache::drop(Shard &shard, Entries::iterator entry) {
+  shard.bytes -= cost(entry->first, entry->second);
+  shard.index.erase(entry->first);
+  shard.entries.erase(entry);
+}
+
+Stats ShardedCache::stats() {
+  Stats result{0, 0, hits_.load(), misses_.load(), evictions_.load()};
+  for (auto &&shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    result.entries += shard->index.size();
+    result.bytes += shard->bytes;
+  }
+  return result;
+}
+
+}  // namespace lru
@@ -0,0 +1,96 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __LRU_CACHE_HPP_
+#define __LRU_CACHE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lru {
+
+struct Stats {
+  std::size_t entries;
+  std::size_t bytes;
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::uint64_t evictions;
+};
+
+/**
+ * String-to-string LRU bounded by bytes, spread over independently locked
+ * shards. An empty value is cached like any other, so a caller can
+ * remember that a key is absent.
+ *
+ * A value read from the backing store on a miss must not overwrite a
+ * write that happened meanwhile: take generation() before the read and
+ * fill() with it afterwards; put() and erase() are for writes.
+ */
+class ShardedCache {
+ public:
+  ShardedCache(std::size_t capacityBytes, std::size_t shards);
+
+  ShardedCache(const ShardedCache &) = delete;
+  ShardedCache &operator=(const ShardedCache &) = delete;
+
+  // Returns false on a miss.
+  bool get(const std::string &key, std::string &value);
+
+  std::uint64_t generation(const std::string &key);
+  // Caches value unless key's shard was written since generation.
+  void fill(const std::string &key, const std::string &value,
+            std::uint64_t generation);
+
+  void put(const std::string &key, const std::string &value);
+  void erase(const std::string &key);
+
+  Stats stats();
+
+ private:
+  using Entries = std::list<std::pair<std::string, std::string>>;
+
+  struct Shard {
+    std::mutex mutex;
+    Entries entries;  // most recently used first
+    std::unordered_map<std::string, Entries::iterator> index;
+    std::size_t bytes = 0;
+    std::uint64_t generation = 0;
+  };
+
+  static std::size_t cost(const std::string &key, const std::string &value);
+
+  Shard &shardOf(const std::string &key);
+  void store(Shard &shard, const std::string &key, const std::string &value);
+  void drop(Shard &shard, Entries::iterator entry);
+
+  const std::size_t shardCapacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> misses_{0};
+  std::atomic<std::uint64_t> evictions_{0};
+};
+
+}  // namespace lru
+
+#endif
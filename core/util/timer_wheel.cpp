@@ -0,0 +1,205 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <exception>
+
+#include "logger.hpp"
+#include "timer_wheel.hpp"
+
+namespace timer {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)),
+      start_(std::chrono::steady_clock::now()),
+      thread_(&TimerWheel::run, this) {}
+
+TimerWheel::~TimerWheel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  wakeup_.notify_all();
+  thread_.join();
+}
+
+TimerId TimerWheel::schedule(std::chrono::milliseconds delay,
+                             std::function<void(void)> action) {
+  std::uint64_t delayTicks = 0;
+  if (delay.count() > 0) {
+    delayTicks = (delay.count() + tick_.count() - 1) / tick_.count();
+  }
+
+  TimerId id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto current = ticksSinceStart();
+    if (index_.empty()) {
+      // nothing is on the wheel, so it can jump straight to the present
+      now_ = current;
+    }
+    id = nextId_++;
+    Slot added;
+    // one extra tick since the current one is already partly over
+    added.push_back(Timer{id, std::max(now_ + 1, current + delayTicks + 1),
+                          std::move(action)});
+    place(added, added.begin());
+    scheduled_++;
+  }
+  wakeup_.notify_one();
+  return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(id);
+  if (found == index_.end()) {
+    return false;
+  }
+  auto &location = found->second;
+  wheels_[location.level][location.slot].erase(location.it);
+  index_.erase(found);
+  cancelled_++;
+  return true;
+}
+
+std::size_t TimerWheel::pending() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size();
+}
+
+Stats TimerWheel::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Stats{index_.size(), scheduled_, fired_, cancelled_};
+}
+
+std::uint64_t TimerWheel::ticksSinceStart() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start_)
+             .count() /
+         tick_.count();
+}
+
+void TimerWheel::place(Slot &from, Slot::iterator it) {
+  const std::uint64_t diff = it->expiry > now_ ? it->expiry - now_ : 0;
+
+  std::size_t level = 0;
+  while (level < LEVELS - 1 && diff >= (1ull << (SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+
+  std::size_t slot;
+  if (diff >= (1ull << (SLOT_BITS * LEVELS))) {
+    // beyond the wheel's range: park it in the slot reached last and let
+    // the cascade place it again
+    slot = ((now_ >> (SLOT_BITS * level)) + SLOTS - 1) & (SLOTS - 1);
+  } else {
+    slot = ((diff == 0 ? now_ : it->expiry) >> (SLOT_BITS * level)) &
+           (SLOTS - 1);
+  }
+
+  auto &target = wheels_[level][slot];
+  target.splice(target.end(), from, it);
+  index_[it->id] = Location{level, slot, it};
+}
+
+void TimerWheel::cascade(std::size_t level) {
+  if (level >= LEVELS) {
+    return;
+  }
+  auto slot = (now_ >> (SLOT_BITS * level)) & (SLOTS - 1);
+  if (slot == 0) {
+    cascade(level + 1);
+  }
+  Slot moving;
+  moving.splice(moving.end(), wheels_[level][slot]);
+  while (!moving.empty()) {
+    place(moving, moving.begin());
+  }
+}
+
+void TimerWheel::advance(std::list<Timer> &expired) {
+  now_++;
+  auto slot = now_ & (SLOTS - 1);
+  if (slot == 0) {
+    cascade(1);
+  }
+  auto &current = wheels_[0][slot];
+  while (!current.empty()) {
+    auto it = current.begin();
+    if (it->expiry <= now_) {
+      index_.erase(it->id);
+      expired.splice(expired.end(), current, it);
+      fired_++;
+    } else {
+      place(current, it);
+    }
+  }
+}
+
+void TimerWheel::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    if (index_.empty()) {
+      wakeup_.wait(lock);
+      continue;
+    }
+
+    std::list<Timer> expired;
+    auto target = ticksSinceStart();
+    while (now_ < target && !index_.empty()) {
+      advance(expired);
+    }
+
+    if (!expired.empty()) {
+      lock.unlock();
+      for (auto &timer : expired) {
+        try {
+          timer.action();
+        } catch (const std::exception &e) {
+          logger::error("timer") << "timer " << timer.id << " threw "
+                                 << e.what();
+        } catch (...) {
+          logger::error("timer") << "timer " << timer.id << " threw";
+        }
+      }
+      lock.lock();
+      continue;
+    }
+
+    wakeup_.wait_until(lock, start_ + tick_ * (now_ + 1));
+  }
+}
+
+namespace detail {
+TimerWheel &wheel() {
+  static TimerWheel instance;
+  return instance;
+}
+}
+
+TimerId schedule(std::chrono::milliseconds delay,
+                 std::function<void(void)> action) {
+  return detail::wheel().schedule(delay, std::move(action));
+}
+
+bool cancel(TimerId id) { return detail::wheel().cancel(id); }
+
+std::size_t pending() { return detail::wheel().pending(); }
+
+Stats stats() { return detail::wheel().stats(); }
+
+}  // namespace timer
@@ -0,0 +1,118 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __TIMER_WHEEL_HPP_
+#define __TIMER_WHEEL_HPP_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace timer {
+
+using TimerId = std::uint64_t;
+
+struct Stats {
+  std::size_t pending;
+  std::uint64_t scheduled;
+  std::uint64_t fired;
+  std::uint64_t cancelled;
+};
+
+/**
+ * Hierarchical timer wheel driven by a single thread.
+ *
+ * Four levels of 64 slots cover 2^24 ticks; longer delays are cascaded
+ * again until they fit. Scheduling and cancelling are O(1).
+ * Actions run on the timer thread, so anything that blocks (gRPC, disk)
+ * has to be handed off to a worker pool by the action itself.
+ */
+class TimerWheel {
+ public:
+  explicit TimerWheel(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  TimerId schedule(std::chrono::milliseconds delay,
+                   std::function<void(void)> action);
+
+  // Returns false if the timer already fired or was cancelled.
+  bool cancel(TimerId id);
+
+  std::size_t pending();
+  Stats stats();
+
+ private:
+  static constexpr std::size_t SLOT_BITS = 6;
+  static constexpr std::size_t SLOTS = 1 << SLOT_BITS;
+  static constexpr std::size_t LEVELS = 4;
+
+  struct Timer {
+    TimerId id;
+    std::uint64_t expiry;  // in ticks
+    std::function<void(void)> action;
+  };
+  using Slot = std::list<Timer>;
+
+  struct Location {
+    std::size_t level;
+    std::size_t slot;
+    Slot::iterator it;
+  };
+
+  std::uint64_t ticksSinceStart() const;
+  void place(Slot &from, Slot::iterator it);
+  void cascade(std::size_t level);
+  void advance(std::list<Timer> &expired);
+  void run();
+
+  const std::chrono::milliseconds tick_;
+  const std::chrono::steady_clock::time_point start_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::array<std::array<Slot, SLOTS>, LEVELS> wheels_;
+  std::unordered_map<TimerId, Location> index_;
+  std::uint64_t now_ = 0;
+  TimerId nextId_ = 1;
+  bool running_ = true;
+
+  std::uint64_t scheduled_ = 0;
+  std::uint64_t fired_ = 0;
+  std::uint64_t cancelled_ = 0;
+
+  std::thread thread_;
+};
+
+// Process-wide wheel shared by consensus, Izanami and Hijiri.
+TimerId schedule(std::chrono::milliseconds delay,
+                 std::function<void(void)> action);
+bool cancel(TimerId id);
+std::size_t pending();
+Stats stats();
+
+}  // namespace timer
+
+#endif
@@ -1,9 +1,13 @@
+#ifndef __USE_OPTIONAL_HPP_
+#define __USE_OPTIONAL_HPP_
 
-#ifdef __has_include
-#  if __has_include(<optional>)
-#    include <optional>
-#    define have_optional 1
-#  elif __has_include(<experimental/optional>)
+// <optional> can be present while the language level is still C++14, in
+// which case it declares nothing; only use it under C++17.
+#if __cplusplus >= 201703L
+#  include <optional>
+#  define have_optional 1
+#elif defined(__has_include)
+#  if __has_include(<experimental/optional>)
 #    include <experimental/optional>
 #    define have_optional 1
 #    define experimental_optional
@@ -11,6 +15,10 @@
 #    define have_optional 0
 #    error "This file requires to use std::experimental::optional (or std::optional). Please update GCC version."
 #  endif
+#else
+#  include <experimental/optional>
+#  define have_optional 1
+#  define experimental_optional
 #endif
 
 #ifdef experimental_optional
@@ -18,7 +26,9 @@ using std::experimental::optional;
 using std::experimental::make_optional;
 using std::experimental::nullopt;
 #else
-using std::optional
+using std::optional;
 using std::make_optional;
-using std:::nullopt;
-#endif
\ No newline at end of file
+using std::nullopt;
+#endif
+
+#endif
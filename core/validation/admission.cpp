@@ -0,0 +1,234 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include <infra/config/iroha_config_with_json.hpp>
+#include <repository/domain/account_repository.hpp>
+#include <repository/domain/asset_repository.hpp>
+#include <util/logger.hpp>
+
+#include "admission.hpp"
+
+namespace admission {
+
+namespace detail {
+
+// Only currency and tax transfers debit "value" from the sender.
+bool debitsValue(const Transaction &tx) {
+  std::string type = tx.type();
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  if (type != "transfer" || !tx.has_asset()) {
+    return false;
+  }
+  const auto &value = tx.asset().value();
+  const auto kind = value.find("type");
+  return value.find("value") != value.end() &&
+         (kind == value.end() || kind->second.valuestring() == "tax");
+}
+
+bool hasValue(const Api::Asset &asset) {
+  return asset.value().find("value") != asset.value().end();
+}
+
+View &view() {
+  static View instance(
+      View::Source{
+          [](const std::string &publicKey) {
+            return repository::account::exists(publicKey);
+          },
+          [](const std::string &publicKey, const std::string &assetName) {
+            return repository::asset::find(publicKey, assetName);
+          }},
+      std::chrono::milliseconds(config::IrohaConfigManager::getInstance()
+                                    .getAdmissionCacheTtlMillis(1000)),
+      config::IrohaConfigManager::getInstance().getAdmissionCacheCapacity(
+          65536));
+  return instance;
+}
+
+Strictness strictness() {
+  static const Strictness configured = parseStrictness(
+      config::IrohaConfigManager::getInstance().getAdmissionStrictness("off"));
+  return configured;
+}
+
+}  // namespace detail
+
+Strictness parseStrictness(const std::string &name) {
+  if (name == "lenient") {
+    return Strictness::LENIENT;
+  }
+  if (name == "strict") {
+    return Strictness::STRICT;
+  }
+  if (name != "off") {
+    logger::warning("admission") << "unknown strictness " << name
+                                 << ", admission checks are off";
+  }
+  return Strictness::OFF;
+}
+
+const char *describe(Verdict verdict) {
+  switch (verdict) {
+    case Verdict::ADMIT:
+      return "admitted";
+    case Verdict::UNKNOWN_SENDER:
+      return "sender has no account";
+    case Verdict::UNKNOWN_RECEIVER:
+      return "receiver has no account";
+    case Verdict::NO_ASSET:
+      return "sender or receiver does not hold the asset";
+    case Verdict::INSUFFICIENT_BALANCE:
+      return "insufficient balance";
+  }
+  return "rejected";
+}
+
+View::View(Source source, std::chrono::milliseconds ttl, std::size_t capacity)
+    : source_(std::move(source)),
+      ttl_(ttl),
+      capacity_(std::max<std::size_t>(1, capacity)) {}
+
+bool View::fresh(Clock::time_point fetchedAt) const {
+  return Clock::now() - fetchedAt < ttl_;
+}
+
+// Entries are cheap to refetch, so a full cache simply starts over.
+void View::makeRoom() {
+  if (accounts_.size() + assets_.size() >= capacity_) {
+    accounts_.clear();
+    assets_.clear();
+  }
+}
+
+bool View::accountExists(const std::string &publicKey) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accounts_.find(publicKey);
+    if (it != accounts_.end() && fresh(it->second.fetchedAt)) {
+      hits_++;
+      return it->second.value;
+    }
+    misses_++;
+  }
+  // the repository is read outside the lock; a racing forget() costs at most
+  // one stale entry until ttl
+  const bool exists = source_.accountExists(publicKey);
+  std::lock_guard<std::mutex> lock(mutex_);
+  makeRoom();
+  accounts_[publicKey] = {exists, Clock::now()};
+  return exists;
+}
+
+Api::Asset View::asset(const std::string &publicKey,
+                       const std::string &assetName) {
+  const AssetKey key{publicKey, assetName};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assets_.find(key);
+    if (it != assets_.end() && fresh(it->second.fetchedAt)) {
+      hits_++;
+      return it->second.value;
+    }
+    misses_++;
+  }
+  auto found = source_.asset(publicKey, assetName);
+  std::lock_guard<std::mutex> lock(mutex_);
+  makeRoom();
+  assets_[key] = {found, Clock::now()};
+  return found;
+}
+
+void View::forget(const Transaction &tx) {
+  std::vector<std::string> touched{tx.senderpubkey(), tx.receivepubkey()};
+  if (tx.has_account()) {
+    touched.push_back(tx.account().publickey());
+  }
+  if (tx.has_asset()) {
+    const auto author = tx.asset().value().find("author");
+    if (author != tx.asset().value().end()) {
+      touched.push_back(author->second.valuestring());
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &&publicKey : touched) {
+    accounts_.erase(publicKey);
+    auto first = assets_.lower_bound(AssetKey{publicKey, ""});
+    auto last = first;
+    while (last != assets_.end() && last->first.first == publicKey) {
+      ++last;
+    }
+    assets_.erase(first, last);
+  }
+}
+
+void View::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  accounts_.clear();
+  assets_.clear();
+}
+
+Stats View::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Stats{hits_, misses_};
+}
+
+Verdict check(const Transaction &tx, View &view, Strictness strictness) {
+  if (strictness == Strictness::OFF || !detail::debitsValue(tx)) {
+    return Verdict::ADMIT;
+  }
+  const auto &assetName = tx.asset().name();
+  const auto amount = tx.asset().value().at("value").valueint();
+
+  if (strictness == Strictness::STRICT) {
+    if (!view.accountExists(tx.senderpubkey())) {
+      return Verdict::UNKNOWN_SENDER;
+    }
+    if (!view.accountExists(tx.receivepubkey())) {
+      return Verdict::UNKNOWN_RECEIVER;
+    }
+    if (!detail::hasValue(view.asset(tx.receivepubkey(), assetName))) {
+      return Verdict::NO_ASSET;
+    }
+  }
+
+  const auto sender = view.asset(tx.senderpubkey(), assetName);
+  if (!detail::hasValue(sender)) {
+    return strictness == Strictness::STRICT ? Verdict::NO_ASSET
+                                            : Verdict::ADMIT;
+  }
+  if (sender.value().at("value").valueint() < amount) {
+    return Verdict::INSUFFICIENT_BALANCE;
+  }
+  return Verdict::ADMIT;
+}
+
+Verdict check(const Transaction &tx) {
+  return check(tx, detail::view(), detail::strictness());
+}
+
+void committed(const Transaction &tx) {
+  if (detail::strictness() != Strictness::OFF) {
+    detail::view().forget(tx);
+  }
+}
+
+Stats stats() { return detail::view().stats(); }
+
+};  // namespace admission
@@ -0,0 +1,125 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_VALIDATION_ADMISSION_HPP_
+#define CORE_VALIDATION_ADMISSION_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <infra/protobuf/api.pb.h>
+
+/**
+ * Stateful checks at Torii. The executor finds out that a Transfer cannot be
+ * applied only after the transaction has been ordered and committed; this
+ * looks at a read-only, cached view of world state first and turns away
+ * transfers that are bound to fail. The view may be stale by up to its ttl,
+ * so it only ever decides whether a transaction is worth ordering; the
+ * executor still has the final word.
+ */
+namespace admission {
+
+using Api::Transaction;
+
+enum class Strictness {
+  OFF,      // admit everything
+  LENIENT,  // reject only a known balance too small for the transfer
+  STRICT,   // also reject unknown accounts and assets
+};
+
+// "off", "lenient" or "strict"; anything else is OFF.
+Strictness parseStrictness(const std::string &name);
+
+enum class Verdict {
+  ADMIT,
+  UNKNOWN_SENDER,        // strict: the sender has no account
+  UNKNOWN_RECEIVER,      // strict: the receiver has no account
+  NO_ASSET,              // strict: sender or receiver lacks the asset
+  INSUFFICIENT_BALANCE,  // the sender's balance is below the amount
+};
+
+const char *describe(Verdict verdict);
+
+struct Stats {
+  std::uint64_t hits;
+  std::uint64_t misses;
+};
+
+/**
+ * Read-through cache over the account and asset repositories. Entries live
+ * for ttl, and forget() drops whatever a committed transaction may have
+ * changed, so a commit is visible to the next check at once.
+ */
+class View {
+ public:
+  struct Source {
+    std::function<bool(const std::string &)> accountExists;
+    std::function<Api::Asset(const std::string &, const std::string &)> asset;
+  };
+
+  View(Source source, std::chrono::milliseconds ttl, std::size_t capacity);
+
+  bool accountExists(const std::string &publicKey);
+  // An empty Asset if the account does not hold assetName.
+  Api::Asset asset(const std::string &publicKey, const std::string &assetName);
+
+  void forget(const Transaction &tx);
+  void clear();
+  Stats stats();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  template <typename T>
+  struct Cached {
+    T value;
+    Clock::time_point fetchedAt;
+  };
+  // (publicKey, assetName); ordered so that one account's entries are
+  // adjacent
+  using AssetKey = std::pair<std::string, std::string>;
+
+  bool fresh(Clock::time_point fetchedAt) const;
+  void makeRoom();
+
+  const Source source_;
+  const std::chrono::milliseconds ttl_;
+  const std::size_t capacity_;
+
+  std::mutex mutex_;
+  std::map<std::string, Cached<bool>> accounts_;
+  std::map<AssetKey, Cached<Api::Asset>> assets_;
+  std::uint64_t hits_ = 0;
+  std::uint64_t misses_ = 0;
+};
+
+Verdict check(const Transaction &tx, View &view, Strictness strictness);
+
+// Against the process-wide view, at admission_strictness.
+Verdict check(const Transaction &tx);
+
+// Called once tx is applied to world state.
+void committed(const Transaction &tx);
+
+Stats stats();
+
+};  // namespace admission
+
+#endif  // CORE_VALIDATION_ADMISSION_HPP_
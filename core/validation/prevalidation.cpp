@@ -0,0 +1,148 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include <thread_pool.hpp>
+
+#include <infra/config/iroha_config_with_json.hpp>
+#include <util/logger.hpp>
+
+#include "prevalidation.hpp"
+#include "transaction_validator.hpp"
+
+namespace prevalidation {
+
+namespace detail {
+
+std::array<std::atomic<std::uint64_t>, VERDICTS> verdicts{};
+std::array<std::atomic<std::uint64_t>, LATENCY_BOUNDS_MICROS.size() + 1>
+    latency{};
+
+ThreadPool &pool() {
+  static ThreadPool instance(ThreadPoolOptions{
+      .threads_count = [] {
+        auto configured = config::IrohaConfigManager::getInstance()
+                              .getPrevalidationConcurrency(0);
+        return configured > 0 ? configured
+                              : std::max<std::size_t>(
+                                    1, std::thread::hardware_concurrency());
+      }(),
+      .worker_queue_size =
+          config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(
+              1024),
+  });
+  return instance;
+}
+
+std::size_t maxBytes() {
+  static const std::size_t bytes =
+      config::IrohaConfigManager::getInstance().getTxMaxBytes(65536);
+  return bytes;
+}
+
+bool requireSignature() {
+  static const bool required =
+      config::IrohaConfigManager::getInstance().getPrevalidationRequireSignature(
+          false);
+  return required;
+}
+
+Verdict inspect(const Transaction &tx, const std::string &digest) {
+  if (static_cast<std::size_t>(tx.ByteSize()) > maxBytes()) {
+    return Verdict::TOO_LARGE;
+  }
+  if (tx.type().empty() || tx.senderpubkey().empty()) {
+    return Verdict::MALFORMED;
+  }
+  if (tx.txsignatures_size() == 0) {
+    return requireSignature() ? Verdict::UNSIGNED : Verdict::VALID;
+  }
+  return transaction_validator::signaturesAreValid(tx, digest)
+             ? Verdict::VALID
+             : Verdict::BAD_SIGNATURE;
+}
+
+void record(Verdict verdict) {
+  verdicts[static_cast<std::size_t>(verdict)]++;
+}
+
+void recordLatency(std::chrono::steady_clock::duration elapsed) {
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  const auto bucket =
+      std::lower_bound(LATENCY_BOUNDS_MICROS.begin(),
+                       LATENCY_BOUNDS_MICROS.end(), micros) -
+      LATENCY_BOUNDS_MICROS.begin();
+  latency[bucket]++;
+}
+
+}  // namespace detail
+
+const char *describe(Verdict verdict) {
+  switch (verdict) {
+    case Verdict::VALID:
+      return "valid";
+    case Verdict::TOO_LARGE:
+      return "transaction is too large";
+    case Verdict::MALFORMED:
+      return "transaction lacks a type or a sender";
+    case Verdict::UNSIGNED:
+      return "transaction is not signed";
+    case Verdict::BAD_SIGNATURE:
+      return "invalid transaction signature";
+    case Verdict::BUSY:
+      return "pre-validation is overloaded";
+  }
+  return "invalid transaction";
+}
+
+Verdict check(const Transaction &tx, const std::string &digest) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto verdict = detail::inspect(tx, digest);
+  detail::recordLatency(std::chrono::steady_clock::now() - start);
+  detail::record(verdict);
+  return verdict;
+}
+
+std::future<Verdict> submit(const Transaction &tx, const std::string &digest) {
+  try {
+    return detail::pool().process(
+        [tx, digest] { return check(tx, digest); });
+  } catch (const std::exception &e) {
+    logger::warning("prevalidation") << e.what();
+    detail::record(Verdict::BUSY);
+    std::promise<Verdict> busy;
+    busy.set_value(Verdict::BUSY);
+    return busy.get_future();
+  }
+}
+
+Stats stats() {
+  Stats result;
+  for (std::size_t i = 0; i < VERDICTS; i++) {
+    result.verdicts[i] = detail::verdicts[i].load();
+  }
+  for (auto &&bucket : detail::latency) {
+    result.latency.push_back(bucket.load());
+  }
+  return result;
+}
+
+};  // namespace prevalidation
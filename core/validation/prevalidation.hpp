@@ -0,0 +1,80 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_VALIDATION_PREVALIDATION_HPP_
+#define CORE_VALIDATION_PREVALIDATION_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+/**
+ * Stateless checks a transaction has to pass at Torii before it may cost a
+ * consensus round: size, required fields and signatures. They need nothing
+ * but the transaction itself. Torii runs them inline on the gRPC worker
+ * that took the call, so they run in parallel across transactions without
+ * a thread waiting on another; submit() is for callers that must not block.
+ */
+namespace prevalidation {
+
+using Api::Transaction;
+
+enum class Verdict {
+  VALID,
+  TOO_LARGE,     // serialized size over tx_max_bytes
+  MALFORMED,     // no type or no sender
+  UNSIGNED,      // prevalidation_require_signature and no signature
+  BAD_SIGNATURE, // a signature does not verify over the digest
+  BUSY,          // the pre-validation pool is saturated
+};
+
+constexpr std::size_t VERDICTS = 6;
+
+const char *describe(Verdict verdict);
+
+// The digest is sumeragi::hashTransaction(tx), which the caller works out
+// once at ingress; signatures are verified over it and never over the hash
+// field the client sent.
+
+// Runs the checks on the calling thread.
+Verdict check(const Transaction &tx, const std::string &digest);
+
+// Runs the checks on a pool of their own, started on first use. The future
+// is ready at once with BUSY if the pool's queue is full.
+std::future<Verdict> submit(const Transaction &tx, const std::string &digest);
+
+// Upper bounds of the latency buckets, in microseconds; a last, unbounded
+// bucket follows.
+constexpr std::array<std::uint32_t, 10> LATENCY_BOUNDS_MICROS = {
+    {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000}};
+
+struct Stats {
+  // by Verdict
+  std::array<std::uint64_t, VERDICTS> verdicts;
+  // time spent in check(), LATENCY_BOUNDS_MICROS.size() + 1 buckets
+  std::vector<std::uint64_t> latency;
+};
+
+Stats stats();
+
+};  // namespace prevalidation
+
+#endif  // CORE_VALIDATION_PREVALIDATION_HPP_
@@ -0,0 +1,128 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <bitset>
+
+#include "signature_set.hpp"
+
+namespace signature_set {
+
+namespace detail {
+
+bool isSet(const std::string &bitmap, std::uint32_t signer) {
+  return signer / 8 < bitmap.size() &&
+         (static_cast<unsigned char>(bitmap[signer / 8]) >> (signer % 8)) & 1;
+}
+
+constexpr std::size_t SIGNATURE_SIZE = 64;
+
+std::size_t bits(unsigned char byte) { return std::bitset<8>(byte).count(); }
+
+// Number of signers before signer, which is where its signature goes.
+int rank(const std::string &bitmap, std::uint32_t signer) {
+  const std::size_t whole = std::min<std::size_t>(signer / 8, bitmap.size());
+  std::size_t before = 0;
+  for (std::size_t i = 0; i < whole; i++) {
+    before += bits(bitmap[i]);
+  }
+  if (signer / 8 < bitmap.size()) {
+    before += bits(static_cast<unsigned char>(bitmap[signer / 8]) &
+                   ((1u << (signer % 8)) - 1));
+  }
+  return before;
+}
+
+}  // namespace detail
+
+bool contains(const SignatureSet &set, std::uint32_t signer) {
+  return detail::isSet(set.bitmap(), signer);
+}
+
+bool add(SignatureSet &set, std::uint32_t signer,
+         const std::string &signature) {
+  if (contains(set, signer)) {
+    return false;
+  }
+  const auto position = detail::rank(set.bitmap(), signer);
+  auto bitmap = set.mutable_bitmap();
+  if (bitmap->size() <= signer / 8) {
+    bitmap->resize(signer / 8 + 1, '\0');
+  }
+  (*bitmap)[signer / 8] = static_cast<char>(
+      static_cast<unsigned char>((*bitmap)[signer / 8]) | (1u << (signer % 8)));
+
+  auto signatures = set.mutable_signatures();
+  *signatures->Add() = signature;
+  for (int i = signatures->size() - 1; i > position; i--) {
+    signatures->SwapElements(i, i - 1);
+  }
+  return true;
+}
+
+std::size_t merge(SignatureSet &into, const SignatureSet &from) {
+  if (count(into) == 0) {
+    into.set_peersetversion(from.peersetversion());
+  } else if (into.peersetversion() != from.peersetversion()) {
+    return 0;
+  }
+  std::size_t added = 0;
+  auto fromSigners = signers(from);
+  if (fromSigners.size() != count(from)) {
+    return 0;
+  }
+  for (std::size_t i = 0; i < fromSigners.size(); i++) {
+    added += add(into, fromSigners[i], from.signatures(i));
+  }
+  return added;
+}
+
+bool wellFormed(const SignatureSet &set, std::size_t peerCount) {
+  const auto &bitmap = set.bitmap();
+  if (bitmap.size() > (peerCount + 7) / 8) {
+    return false;
+  }
+  std::size_t present = 0;
+  for (std::size_t i = 0; i < bitmap.size(); i++) {
+    present += detail::bits(bitmap[i]);
+  }
+  if (present != count(set)) {
+    return false;
+  }
+  for (std::uint32_t i = peerCount; i < bitmap.size() * 8; i++) {
+    if (detail::isSet(bitmap, i)) {
+      return false;
+    }
+  }
+  for (const auto &signature : set.signatures()) {
+    if (signature.size() != detail::SIGNATURE_SIZE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::uint32_t> signers(const SignatureSet &set) {
+  std::vector<std::uint32_t> indices;
+  const auto &bitmap = set.bitmap();
+  for (std::uint32_t i = 0; i < bitmap.size() * 8; i++) {
+    if (detail::isSet(bitmap, i)) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+};  // namespace signature_set
@@ -0,0 +1,61 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_VALIDATION_SIGNATURESET_HPP_
+#define CORE_VALIDATION_SIGNATURESET_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+/**
+ * Helpers for Api::SignatureSet, which names signers by their index in a
+ * versioned peer set and keeps raw signatures behind a presence bitmap.
+ * Every signer has at most one signature in a set, so the number of
+ * signers is the length of signatures and a quorum check is O(1).
+ */
+namespace signature_set {
+
+using Api::SignatureSet;
+
+bool contains(const SignatureSet &set, std::uint32_t signer);
+
+// Adds the raw signature of signer, keeping signatures in signer order.
+// Returns false, leaving the set alone, if signer is already present.
+bool add(SignatureSet &set, std::uint32_t signer, const std::string &signature);
+
+// Adds every signer of from that into is missing and returns how many were
+// added. An empty into takes over the peer set version of from; sets of two
+// different versions do not merge and 0 is returned.
+std::size_t merge(SignatureSet &into, const SignatureSet &from);
+
+inline std::size_t count(const SignatureSet &set) {
+  return set.signatures_size();
+}
+
+// Signer indices in ascending order, parallel to set.signatures().
+std::vector<std::uint32_t> signers(const SignatureSet &set);
+
+// Whether a set received from another peer can be used as it is: no signer
+// at or past peerCount, and one 64-byte signature per signer. The other
+// helpers assume this holds.
+bool wellFormed(const SignatureSet &set, std::size_t peerCount);
+
+};  // namespace signature_set
+
+#endif  // CORE_VALIDATION_SIGNATURESET_HPP_
@@ -0,0 +1,188 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <thread_pool.hpp>
+
+#include <crypto/base64.hpp>
+#include <crypto/signature.hpp>
+#include <infra/config/iroha_config_with_json.hpp>
+#include <util/logger.hpp>
+
+#include "signature_set.hpp"
+#include "signature_verifier.hpp"
+
+namespace signature_verifier {
+
+namespace detail {
+
+// below this many signatures, handing off costs more than it saves
+constexpr int PARALLEL_THRESHOLD = 4;
+// the decoded key cache is dropped once it reaches this size
+constexpr std::size_t MAX_DECODED_KEYS = 4096;
+
+std::size_t concurrency() {
+  static const std::size_t threads = [] {
+    auto configured =
+        config::IrohaConfigManager::getInstance().getVerifyConcurrency(0);
+    return configured > 0
+               ? configured
+               : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }();
+  return threads;
+}
+
+ThreadPool &pool() {
+  static ThreadPool instance(ThreadPoolOptions{
+      .threads_count = concurrency(),
+      .worker_queue_size =
+          config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(
+              1024),
+  });
+  return instance;
+}
+
+std::mutex keysMutex;
+std::unordered_map<std::string, signature::byte_array_t> decodedKeys;
+
+signature::byte_array_t decodeKey(const std::string &publicKey_b64) {
+  std::lock_guard<std::mutex> lock(keysMutex);
+  auto found = decodedKeys.find(publicKey_b64);
+  if (found != decodedKeys.end()) {
+    return found->second;
+  }
+  if (decodedKeys.size() >= MAX_DECODED_KEYS) {
+    decodedKeys.clear();
+  }
+  return decodedKeys[publicKey_b64] = base64::decode(publicKey_b64);
+}
+
+bool verifyOne(const Api::Signature &sig, const std::string &message) {
+  auto publicKey = decodeKey(sig.publickey());
+  auto decoded = base64::decode(sig.signature());
+  if (publicKey.size() != signature::PUB_KEY_SIZE ||
+      decoded.size() != signature::SIG_SIZE) {
+    return false;
+  }
+  return signature::verify(decoded, message, publicKey);
+}
+
+bool verifyRaw(const std::string &signature, const std::string &message,
+               const std::string &publicKey_b64) {
+  auto publicKey = decodeKey(publicKey_b64);
+  if (publicKey.size() != signature::PUB_KEY_SIZE ||
+      signature.size() != signature::SIG_SIZE) {
+    return false;
+  }
+  return signature::verify(
+      signature::byte_array_t(signature.begin(), signature.end()), message,
+      publicKey);
+}
+
+// Runs check(0..count) and returns the results in order.
+template <typename Check>
+std::vector<bool> verifyEach(const int count, const Check &check) {
+  std::vector<bool> bitmap(count, false);
+  if (count < PARALLEL_THRESHOLD) {
+    for (int i = 0; i < count; i++) {
+      bitmap[i] = check(i);
+    }
+    return bitmap;
+  }
+
+  // std::vector<bool> packs bits, so each chunk writes to its own buffer
+  const int chunks = std::min<int>(count, static_cast<int>(concurrency()));
+  const auto run = [&check, count, chunks](int c) {
+    std::vector<char> valid;
+    for (int i = count * c / chunks; i < count * (c + 1) / chunks; i++) {
+      valid.push_back(check(i));
+    }
+    return valid;
+  };
+  // chunk 0 and whatever the pool would not take run here; helpers hold a
+  // reference to check, so every one is waited for before returning
+  std::vector<std::future<std::vector<char>>> helpers;
+  try {
+    for (int c = 1; c < chunks; c++) {
+      helpers.push_back(pool().process([&run, c] { return run(c); }));
+    }
+  } catch (const std::exception &e) {
+    logger::warning("signature_verifier") << e.what();
+  }
+  const int queued = static_cast<int>(helpers.size()) + 1;
+  std::vector<std::vector<char>> results(chunks);
+  std::exception_ptr failed;
+  try {
+    results[0] = run(0);
+    for (int c = queued; c < chunks; c++) {
+      results[c] = run(c);
+    }
+  } catch (...) {
+    failed = std::current_exception();
+  }
+  for (auto &&helper : helpers) {
+    helper.wait();
+  }
+  if (failed) {
+    std::rethrow_exception(failed);
+  }
+  for (int c = 1; c < queued; c++) {
+    results[c] = helpers[c - 1].get();
+  }
+
+  int i = 0;
+  for (auto &&result : results) {
+    for (auto valid : result) {
+      bitmap[i++] = valid;
+    }
+  }
+  return bitmap;
+}
+
+}  // namespace detail
+
+std::vector<bool> verify(const Signatures &signatures,
+                         const std::string &message, int from) {
+  return detail::verifyEach(
+      std::max(0, signatures.size() - from), [&](int i) {
+        return detail::verifyOne(signatures.Get(from + i), message);
+      });
+}
+
+std::vector<bool> verify(const Api::SignatureSet &set,
+                         const std::string &message,
+                         const std::vector<std::string> &publicKeys) {
+  const auto signers = signature_set::signers(set);
+  return detail::verifyEach(set.signatures_size(), [&](int i) {
+    return i < static_cast<int>(signers.size()) &&
+           signers[i] < publicKeys.size() &&
+           detail::verifyRaw(set.signatures(i), message,
+                             publicKeys[signers[i]]);
+  });
+}
+
+bool verifyRaw(const std::string &signature, const std::string &message,
+               const std::string &publicKey_b64) {
+  return detail::verifyRaw(signature, message, publicKey_b64);
+}
+
+};  // namespace signature_verifier
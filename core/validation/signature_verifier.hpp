@@ -0,0 +1,53 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CORE_VALIDATION_SIGNATUREVERIFIER_HPP_
+#define CORE_VALIDATION_SIGNATUREVERIFIER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <infra/protobuf/api.pb.h>
+
+namespace signature_verifier {
+
+using Signatures = google::protobuf::RepeatedPtrField<Api::Signature>;
+
+/**
+ * Verifies signatures[from..] over message and returns one entry per
+ * signature, true if it is valid.
+ *
+ * Larger sets are split across a pool dedicated to verification. Public
+ * keys are base64-decoded once and kept, since the same peers sign every
+ * round.
+ */
+std::vector<bool> verify(const Signatures &signatures,
+                         const std::string &message, int from = 0);
+
+// The same for the raw signatures of a set. publicKeys are base64 and
+// indexed like the signers of the set, that is by the peer list of
+// set.peerSetVersion(); a signer without a key is invalid.
+std::vector<bool> verify(const Api::SignatureSet &set,
+                         const std::string &message,
+                         const std::vector<std::string> &publicKeys);
+
+// One raw 64-byte signature against a base64 public key.
+bool verifyRaw(const std::string &signature, const std::string &message,
+               const std::string &publicKey_b64);
+
+};  // namespace signature_verifier
+
+#endif  // CORE_VALIDATION_SIGNATUREVERIFIER_HPP_
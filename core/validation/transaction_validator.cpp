@@ -50,26 +50,30 @@ namespace transaction_validator {
 
     template<>
     bool signaturesAreValid<ConsensusEvent>(const ConsensusEvent& ev) {
-        auto s = ev.eventsignatures();
-        auto tx = ev.transaction();
+        const auto& s = ev.eventsignatures();
+        const auto& tx = ev.transaction();
         return areValid(s, tx.hash());
     }
 
     template<>
     bool signaturesAreValid<Transaction>(const Transaction& tx) {
-        auto s = tx.txsignatures();
+        const auto& s = tx.txsignatures();
         return areValid(s, tx.hash());
     }
 
+    bool signaturesAreValid(const Transaction& tx, const std::string& digest) {
+        return areValid(tx.txsignatures(), digest);
+    }
+
     template<>
     std::uint32_t countValidSignatures<ConsensusEvent>(const ConsensusEvent& ev) {
-        auto s = ev.eventsignatures();
-        auto tx = ev.transaction();
+        const auto& s = ev.eventsignatures();
+        const auto& tx = ev.transaction();
         return countValid(s, tx.hash());
     }
 
     std::uint32_t countValidSignatures(const Transaction& tx) {
-        auto s = tx.txsignatures();
+        const auto& s = tx.txsignatures();
         return countValid(s, tx.hash());
     }
 };
@@ -18,6 +18,7 @@ limitations under the License.
 #define CORE_VALIDATION_TRANSACTIONVALIDATOR_HPP_
 
 #include <memory>
+#include <string>
 #include <type_traits>
 
 #include <consensus/consensus_event.hpp>
@@ -37,6 +38,10 @@ namespace transaction_validator {
     template<typename Event>
     std::uint32_t countValidSignatures(const Event& event);
 
+    // Over a digest the caller worked out from the transaction body,
+    // rather than the hash field the sender filled in.
+    bool signaturesAreValid(const Api::Transaction& tx, const std::string& digest);
+
 };  // namespace transaction_validator
 
 #endif  // CORE_VALIDATION_TRANSACTIONVALIDATOR_HPP_
@@ -0,0 +1,123 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <consensus/mempool.hpp>
+
+using Api::Transaction;
+using mempool::Admission;
+
+namespace {
+
+mempool::Options options(std::size_t capacity, std::size_t senderCapacity) {
+  return mempool::Options{capacity, senderCapacity,
+                          std::chrono::milliseconds(60000),
+                          std::chrono::milliseconds(100)};
+}
+
+Transaction from(const std::string &sender) {
+  Transaction tx;
+  tx.set_senderpubkey(sender);
+  return tx;
+}
+
+}  // namespace
+
+TEST(mempool, rejects_duplicates) {
+  mempool::Mempool pool(options(10, 10));
+  ASSERT_EQ(pool.add(from("alice"), "d1").status, Admission::ACCEPTED);
+  ASSERT_EQ(pool.add(from("alice"), "d1").status, Admission::DUPLICATE);
+  ASSERT_EQ(pool.add(from("bob"), "d1").status, Admission::DUPLICATE);
+  ASSERT_EQ(pool.size(), 1u);
+
+  pool.takeBatch(10);
+  // once taken, the digest is the committed-transaction cache's business
+  ASSERT_EQ(pool.add(from("alice"), "d1").status, Admission::ACCEPTED);
+}
+
+TEST(mempool, takes_round_robin_across_senders) {
+  mempool::Mempool pool(options(10, 10));
+  pool.add(from("alice"), "a1");
+  pool.add(from("alice"), "a2");
+  pool.add(from("alice"), "a3");
+  pool.add(from("bob"), "b1");
+  pool.add(from("carol"), "c1");
+  pool.add(from("carol"), "c2");
+
+  auto batch = pool.takeBatch(4);
+  ASSERT_EQ(batch.size(), 4u);
+  ASSERT_EQ(batch[0].digest, "a1");
+  ASSERT_EQ(batch[1].digest, "b1");
+  ASSERT_EQ(batch[2].digest, "c1");
+  ASSERT_EQ(batch[3].digest, "a2");
+
+  batch = pool.takeBatch(4);
+  ASSERT_EQ(batch.size(), 2u);
+  ASSERT_EQ(batch[0].digest, "c2");
+  ASSERT_EQ(batch[1].digest, "a3");
+  ASSERT_EQ(pool.size(), 0u);
+  ASSERT_EQ(pool.stats().senders, 0u);
+}
+
+TEST(mempool, evicts_from_the_longest_queue_when_full) {
+  mempool::Mempool pool(options(4, 10));
+  pool.add(from("alice"), "a1");
+  pool.add(from("alice"), "a2");
+  pool.add(from("alice"), "a3");
+  pool.add(from("bob"), "b1");
+
+  // bob has 1 queued, alice 3: alice's newest makes room
+  ASSERT_EQ(pool.add(from("bob"), "b2").status, Admission::ACCEPTED);
+  ASSERT_EQ(pool.stats().evicted, 1u);
+  ASSERT_EQ(pool.add(from("alice"), "a3").status, Admission::FULL);
+
+  // now 2 and 2: nobody is evicted for either
+  auto full = pool.add(from("bob"), "b3");
+  ASSERT_EQ(full.status, Admission::FULL);
+  ASSERT_GE(full.retryAfter.count(), 100);
+  ASSERT_EQ(pool.size(), 4u);
+  ASSERT_EQ(pool.stats().rejected, 2u);
+}
+
+TEST(mempool, bounds_each_sender) {
+  mempool::Mempool pool(options(10, 2));
+  pool.add(from("alice"), "a1");
+  pool.add(from("alice"), "a2");
+  auto result = pool.add(from("alice"), "a3");
+  ASSERT_EQ(result.status, Admission::SENDER_FULL);
+  ASSERT_GT(result.retryAfter.count(), 0);
+  ASSERT_EQ(pool.add(from("bob"), "b1").status, Admission::ACCEPTED);
+}
+
+TEST(mempool, expires_after_ttl) {
+  mempool::Mempool pool(mempool::Options{10, 10, std::chrono::milliseconds(20),
+                                         std::chrono::milliseconds(100)});
+  pool.add(from("alice"), "a1");
+  pool.add(from("bob"), "b1");
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  pool.add(from("alice"), "a2");
+
+  ASSERT_EQ(pool.expire(), 2u);
+  ASSERT_EQ(pool.size(), 1u);
+  ASSERT_EQ(pool.stats().senders, 1u);
+  ASSERT_EQ(pool.stats().expired, 2u);
+  ASSERT_EQ(pool.takeBatch(10)[0].digest, "a2");
+}
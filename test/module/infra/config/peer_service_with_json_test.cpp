@@ -111,3 +111,23 @@ TEST(peer_service_with_json_test, leader_peer_check_test) {
   }
   ASSERT_TRUE(::peer::myself::isLeader());
 }
+
+TEST(peer_service_with_json_test, peer_set_snapshot_test) {
+  auto before = ::peer::service::getPeerSet();
+  ASSERT_TRUE(::peer::transaction::executor::add(
+      peer::Node("ip_snapshot", "publicKey_snapshot", 0.1)));
+  auto after = ::peer::service::getPeerSet();
+
+  ASSERT_GT(after->version, before->version);
+  // a snapshot never changes once published
+  ASSERT_TRUE(before->findIp("ip_snapshot") == nullptr);
+  ASSERT_TRUE(after->findPublicKey("publicKey_snapshot") != nullptr);
+  ASSERT_TRUE(after->isActiveIp("ip_snapshot"));
+
+  ASSERT_EQ(after->ips.size(), after->nodes.size());
+  for (std::size_t i = 1; i < after->nodes.size(); i++) {
+    ASSERT_GE(after->nodes[i - 1]->trustScore, after->nodes[i]->trustScore);
+    ASSERT_EQ(after->ips[i], after->nodes[i]->ip);
+  }
+  ASSERT_EQ(after->maxFaulty, (after->nodes.size() - 1) / 3);
+}
@@ -0,0 +1,69 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <infra/repository/leveldb_settings.hpp>
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+
+using repository::world_state_repository::LeveldbSettings;
+using repository::world_state_repository::leveldbProfile;
+using repository::world_state_repository::leveldbSettings;
+
+namespace {
+
+void expectSame(const LeveldbSettings &a, const LeveldbSettings &b) {
+    EXPECT_EQ(a.blockCacheBytes, b.blockCacheBytes);
+    EXPECT_EQ(a.bloomBitsPerKey, b.bloomBitsPerKey);
+    EXPECT_EQ(a.writeBufferBytes, b.writeBufferBytes);
+    EXPECT_EQ(a.maxOpenFiles, b.maxOpenFiles);
+    EXPECT_EQ(a.blockSize, b.blockSize);
+    EXPECT_EQ(a.compression, b.compression);
+}
+
+}
+
+TEST(leveldb_settings, profiles_are_picked_by_name) {
+    const auto low = leveldbProfile("low-memory");
+    const auto standard = leveldbProfile("default");
+    const auto high = leveldbProfile("high-throughput");
+    ASSERT_LT(low.blockCacheBytes, standard.blockCacheBytes);
+    ASSERT_LT(standard.blockCacheBytes, high.blockCacheBytes);
+    ASSERT_LT(low.writeBufferBytes, high.writeBufferBytes);
+    ASSERT_LT(low.maxOpenFiles, high.maxOpenFiles);
+
+    expectSame(leveldbProfile("no-such-profile"), standard);
+}
+
+TEST(leveldb_settings, keys_override_the_profile) {
+    // the config is read once, on first use, from $IROHA_HOME
+    const std::string home = "/tmp/leveldb_settings_test";
+    mkdir(home.c_str(), 0755);
+    mkdir((home + "/config").c_str(), 0755);
+    std::ofstream(home + "/config/config.json")
+        << "{\"leveldb_profile\": \"low-memory\","
+        << " \"leveldb_block_cache_bytes\": 12345,"
+        << " \"leveldb_compression\": \"none\"}";
+    setenv("IROHA_HOME", home.c_str(), 1);
+
+    auto expected = leveldbProfile("low-memory");
+    expected.blockCacheBytes = 12345;
+    expected.compression = false;
+    expectSame(leveldbSettings(), expected);
+}
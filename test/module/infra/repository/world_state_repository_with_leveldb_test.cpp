@@ -19,13 +19,18 @@ limitations under the License.
 //
 
 
+#include <infra/config/iroha_config_with_json.hpp>
 #include <repository/world_state_repository.hpp>
 
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 const std::string key = "name";
 std::string value = "mizuki";
@@ -73,3 +78,117 @@ TEST(World_sate_repository_with_leveldb, FindOrElse){
     ASSERT_STREQ(res.c_str(), "iori");
 }
 
+
+TEST(World_sate_repository_with_leveldb, BlockOverlay){
+    repository::world_state_repository::add(key, value);
+    repository::world_state_repository::BlockOverlay overlay;
+    {
+        repository::world_state_repository::ScopeGuard scope(&overlay);
+        repository::world_state_repository::update(key, value + "sonoko");
+        repository::world_state_repository::add(key + "++", "iori");
+        ASSERT_STREQ(repository::world_state_repository::find(key).c_str(), (value+"sonoko").c_str());
+        repository::world_state_repository::remove(key + "++");
+        ASSERT_FALSE(repository::world_state_repository::exists(key + "++"));
+    }
+    // nothing reaches the database before commit
+    ASSERT_STREQ(repository::world_state_repository::find(key).c_str(), value.c_str());
+
+    ASSERT_TRUE(overlay.commit());
+    ASSERT_STREQ(repository::world_state_repository::find(key).c_str(), (value+"sonoko").c_str());
+    ASSERT_STREQ(repository::world_state_repository::find(key + "++").c_str(), "");
+}
+
+TEST(World_sate_repository_with_leveldb, TryFindPutErase){
+    ASSERT_TRUE(repository::world_state_repository::put(key, value));
+    auto res = repository::world_state_repository::tryFind(key);
+    ASSERT_TRUE(static_cast<bool>(res));
+    ASSERT_STREQ(res->c_str(), value.c_str());
+
+    ASSERT_TRUE(repository::world_state_repository::erase(key));
+    ASSERT_FALSE(repository::world_state_repository::tryFind(key));
+    // blind: erasing an absent key is not an error
+    ASSERT_TRUE(repository::world_state_repository::erase(key));
+}
+
+TEST(World_sate_repository_with_leveldb, MultiGet){
+    auto &config = config::IrohaConfigManager::getInstance();
+    // enough misses for multiGet to split them over the readers
+    const auto count = static_cast<int>(config.getMultiGetFanoutThreshold(1024)) * 3 + 1;
+
+    std::vector<std::string> keys;
+    leveldb::WriteBatch batch;
+    for (int i = 0; i < count; i++) {
+        keys.push_back("multiget_" + std::to_string(i));
+        if (i % 3 != 0) {
+            batch.Put(keys.back(), std::to_string(i));
+        }
+    }
+    // Written behind the repository's back, so the LRU knows none of the
+    // keys and every lookup has to reach LevelDB.
+    repository::world_state_repository::finish();
+    {
+        leveldb::DB *db = nullptr;
+        leveldb::Options options;
+        options.create_if_missing = true;
+        ASSERT_TRUE(leveldb::DB::Open(options, config.getDatabasePath("/tmp/iroha_ledger"), &db).ok());
+        ASSERT_TRUE(db->Write(leveldb::WriteOptions(), &batch).ok());
+        delete db;
+    }
+
+    // out of key order, with a duplicate
+    std::reverse(keys.begin(), keys.end());
+    keys.push_back(keys.front());
+
+    const auto before = repository::world_state_repository::cacheStats();
+    auto values = repository::world_state_repository::multiGet(keys);
+    const auto after = repository::world_state_repository::cacheStats();
+    ASSERT_EQ(after.misses - before.misses, keys.size());
+
+    ASSERT_EQ(values.size(), keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        const auto n = std::stoi(keys[i].substr(9));
+        if (n % 3 == 0) {
+            ASSERT_FALSE(values[i]);
+        } else {
+            ASSERT_STREQ(values[i]->c_str(), std::to_string(n).c_str());
+        }
+    }
+
+    // now the cache answers
+    const auto cached = repository::world_state_repository::cacheStats();
+    repository::world_state_repository::multiGet(keys);
+    ASSERT_EQ(repository::world_state_repository::cacheStats().hits - cached.hits, keys.size());
+}
+
+TEST(World_sate_repository_with_leveldb, FindPage){
+    for (int i = 0; i < 25; i++) {
+        repository::world_state_repository::put("paged_" + std::to_string(100 + i), std::to_string(i));
+    }
+    repository::world_state_repository::put("pagedz", "outside");
+
+    std::vector<std::string> seen;
+    std::string token;
+    int pages = 0;
+    do {
+        auto page = repository::world_state_repository::findPage("paged_", token, 10);
+        seen.insert(seen.end(), page.values.begin(), page.values.end());
+        token = page.resumeToken;
+        pages++;
+    } while (!token.empty());
+
+    ASSERT_EQ(pages, 3);
+    ASSERT_EQ(seen.size(), 25u);
+    for (int i = 0; i < 25; i++) {
+        ASSERT_STREQ(seen[i].c_str(), std::to_string(i).c_str());
+    }
+}
+
+TEST(World_sate_repository_with_leveldb, FindPageRejectsForeignToken){
+    repository::world_state_repository::put("paged_100", "0");
+    // would otherwise come back as an empty last page
+    ASSERT_THROW(repository::world_state_repository::findPage("paged_", "pagedz", 10),
+                 std::invalid_argument);
+    ASSERT_THROW(repository::world_state_repository::Cursor("paged_", "a"),
+                 std::invalid_argument);
+    ASSERT_NO_THROW(repository::world_state_repository::findPage("paged_", "paged_100", 10));
+}
@@ -0,0 +1,176 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <repository/domain/asset_repository.hpp>
+#include <repository/world_state_repository.hpp>
+#include <service/block_executor.hpp>
+
+using Api::Transaction;
+namespace wsr = repository::world_state_repository;
+
+namespace {
+
+using State = std::map<std::string, std::string>;
+
+// Committed state for the serial reference run.
+class MapScope : public wsr::Scope {
+public:
+    explicit MapScope(State& state): state_(state) {}
+    std::string find(const std::string& key) override {
+        auto it = state_.find(key);
+        return it == state_.end() ? "" : it->second;
+    }
+    void put(const std::string& key, const std::string& value) override {
+        state_[key] = value;
+    }
+    void erase(const std::string& key) override {
+        state_.erase(key);
+    }
+private:
+    State& state_;
+};
+
+// A transfer that only goes through when the sender can cover it; an
+// amount of zero closes the sender's account instead.
+void transfer(const Transaction& tx) {
+    const auto from = "balance_" + tx.senderpubkey();
+    const auto to = "balance_" + tx.receivepubkey();
+    const auto amount = tx.asset().value().at("value").valueint();
+    auto balance = wsr::find(from);
+    if (balance.empty()) {
+        return;
+    }
+    if (amount == 0) {
+        wsr::remove(from);
+        return;
+    }
+    if (std::stoll(balance) < amount) {
+        return;
+    }
+    wsr::update(from, std::to_string(std::stoll(balance) - amount));
+    auto received = wsr::findOrElse(to, "0");
+    wsr::add(to, std::to_string(std::stoll(received) + amount));
+}
+
+std::vector<Transaction> randomBlock(std::size_t size, int accounts, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<Transaction> block(size);
+    for (auto& tx : block) {
+        tx.set_type("transfer");
+        tx.set_senderpubkey(std::to_string(random() % accounts));
+        tx.set_receivepubkey(std::to_string(random() % accounts));
+        (*tx.mutable_asset()->mutable_value())["value"].set_valueint(random() % 40);
+    }
+    return block;
+}
+
+State initialState(int accounts) {
+    State state;
+    for (int i = 0; i < accounts; i++) {
+        state["balance_" + std::to_string(i)] = "100";
+    }
+    return state;
+}
+
+void expectSerialOutcome(int accounts, unsigned seed) {
+    const auto block = randomBlock(300, accounts, seed);
+    std::vector<const Transaction*> pointers;
+    for (auto& tx : block) {
+        pointers.push_back(&tx);
+    }
+
+    auto serial = initialState(accounts);
+    {
+        MapScope scope(serial);
+        wsr::ScopeGuard guard(&scope);
+        for (auto& tx : block) {
+            transfer(tx);
+        }
+    }
+
+    auto parallel = initialState(accounts);
+    const auto committed = initialState(accounts);
+    auto writes = block_executor::run(pointers, transfer,
+        [&committed](const std::string& key) {
+            auto it = committed.find(key);
+            return it == committed.end() ? "" : it->second;
+        }, 4);
+    ASSERT_TRUE(std::is_sorted(writes.begin(), writes.end(),
+        [](const block_executor::Write& a, const block_executor::Write& b) {
+            return a.key < b.key;
+        }));
+    for (auto& write : writes) {
+        if (write.value.empty()) {
+            parallel.erase(write.key);
+        } else {
+            parallel[write.key] = write.value;
+        }
+    }
+    ASSERT_EQ(parallel, serial);
+}
+
+}
+
+TEST(block_executor, matches_serial_execution_with_disjoint_accounts) {
+    for (unsigned seed = 0; seed < 20; seed++) {
+        expectSerialOutcome(1000, seed);
+    }
+}
+
+TEST(block_executor, matches_serial_execution_under_contention) {
+    auto before = block_executor::stats();
+    for (unsigned seed = 0; seed < 20; seed++) {
+        expectSerialOutcome(3, seed);
+    }
+    auto after = block_executor::stats();
+    ASSERT_EQ(after.blocks - before.blocks, 20u);
+    ASSERT_GE(after.executions - before.executions,
+              after.transactions - before.transactions);
+}
+
+TEST(block_executor, block_table_serialises_each_asset_once) {
+    State state;
+    MapScope scope(state);
+    wsr::ScopeGuard guard(&scope);
+    Api::Asset wallet;
+    wallet.set_name("iroha");
+    (*wallet.mutable_value())["value"].set_valueint(0);
+    repository::asset::add("exchange", "iroha", wallet);
+    const auto serialised = state.at("asset_exchange_iroha");
+
+    auto before = repository::asset::coalescingStats();
+    {
+        repository::asset::BlockTable table;
+        for (int i = 1; i <= 10; i++) {
+            auto asset = repository::asset::find("exchange", "iroha");
+            (*asset.mutable_value())["value"].set_valueint(
+                asset.value().at("value").valueint() + i);
+            ASSERT_TRUE(repository::asset::update("exchange", "iroha", asset));
+        }
+        ASSERT_FALSE(repository::asset::update("nobody", "iroha", wallet));
+        ASSERT_EQ(state.at("asset_exchange_iroha"), serialised);
+        ASSERT_TRUE(table.flush());
+    }
+    auto after = repository::asset::coalescingStats();
+    ASSERT_EQ(after.updates - before.updates, 10u);
+    ASSERT_EQ(after.writes - before.writes, 1u);
+    ASSERT_EQ(repository::asset::find("exchange", "iroha").value().at("value").valueint(), 55);
+}
@@ -0,0 +1,75 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <util/dedup_cache.hpp>
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+
+dedup::Digest digestOf(int n) {
+  dedup::Digest digest{};
+  for (std::size_t i = 0; i < digest.size(); i++) {
+    digest[i] = static_cast<std::uint8_t>(n * 31 + i * 17 + (n >> 8));
+  }
+  return digest;
+}
+
+TEST(DedupCache, from_hex) {
+  auto digest = dedup::fromHex(
+      "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a");
+  ASSERT_EQ(digest[0], 0xa7);
+  ASSERT_EQ(digest[31], 0x4a);
+  ASSERT_THROW(dedup::fromHex("a7ff"), std::invalid_argument);
+  ASSERT_THROW(dedup::fromHex(std::string(64, 'z')), std::invalid_argument);
+}
+
+TEST(DedupCache, rejects_duplicates) {
+  dedup::DedupCache cache(1024, 4, 1 << 12);
+  ASSERT_TRUE(cache.insert(digestOf(1), 1));
+  ASSERT_FALSE(cache.insert(digestOf(1), 2));
+  ASSERT_TRUE(cache.contains(digestOf(1)));
+  ASSERT_FALSE(cache.contains(digestOf(2)));
+
+  auto stats = cache.stats();
+  ASSERT_EQ(stats.size, 1);
+  ASSERT_EQ(stats.inserts, 1);
+  ASSERT_EQ(stats.hits, 2);
+}
+
+TEST(DedupCache, evicts_old_rounds) {
+  dedup::DedupCache cache(1024, 4, 1 << 12);
+  for (int i = 0; i < 100; i++) {
+    cache.insert(digestOf(i), i / 10);
+  }
+  cache.evictBefore(5);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(cache.contains(digestOf(i)), i >= 50) << i;
+  }
+  ASSERT_EQ(cache.stats().evictions, 50);
+}
+
+TEST(DedupCache, bounded_by_capacity) {
+  dedup::DedupCache cache(64, 1, 0);
+  for (int i = 0; i < 200; i++) {
+    cache.insert(digestOf(i), i);
+  }
+  ASSERT_EQ(cache.stats().size, 64);
+  // the oldest rounds go first
+  ASSERT_FALSE(cache.contains(digestOf(0)));
+  ASSERT_TRUE(cache.contains(digestOf(199)));
+  ASSERT_EQ(cache.stats().evictions, 136);
+}
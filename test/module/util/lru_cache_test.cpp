@@ -0,0 +1,72 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <util/lru_cache.hpp>
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(LruCache, caches_values_and_absence) {
+  lru::ShardedCache cache(1 << 16, 4);
+  std::string value;
+  ASSERT_FALSE(cache.get("alice", value));
+  cache.put("alice", "100");
+  cache.put("bob", "");
+  ASSERT_TRUE(cache.get("alice", value));
+  ASSERT_EQ(value, "100");
+  ASSERT_TRUE(cache.get("bob", value));
+  ASSERT_EQ(value, "");
+
+  cache.erase("alice");
+  ASSERT_FALSE(cache.get("alice", value));
+
+  auto stats = cache.stats();
+  ASSERT_EQ(stats.entries, 1);
+  ASSERT_EQ(stats.hits, 2);
+  ASSERT_EQ(stats.misses, 2);
+}
+
+TEST(LruCache, evicts_least_recently_used) {
+  // one shard with room for three small entries
+  lru::ShardedCache cache(3 * 110, 1);
+  cache.put("a", "1");
+  cache.put("b", "2");
+  cache.put("c", "3");
+  std::string value;
+  ASSERT_TRUE(cache.get("a", value));
+  cache.put("d", "4");
+  ASSERT_TRUE(cache.get("a", value));
+  ASSERT_FALSE(cache.get("b", value));
+  ASSERT_TRUE(cache.get("d", value));
+  ASSERT_EQ(cache.stats().evictions, 1);
+
+  cache.put("big", std::string(1024, 'x'));
+  ASSERT_FALSE(cache.get("big", value));
+}
+
+TEST(LruCache, fill_never_overwrites_a_newer_write) {
+  lru::ShardedCache cache(1 << 16, 4);
+  auto generation = cache.generation("alice");
+  cache.put("alice", "new");
+  cache.fill("alice", "old", generation);
+  std::string value;
+  ASSERT_TRUE(cache.get("alice", value));
+  ASSERT_EQ(value, "new");
+
+  generation = cache.generation("bob");
+  cache.fill("bob", "", generation);
+  ASSERT_TRUE(cache.get("bob", value));
+}
@@ -0,0 +1,101 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <util/timer_wheel.hpp>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+TEST(TimerWheel, fires_after_delay) {
+  timer::TimerWheel wheel(milliseconds(1));
+  std::atomic<bool> fired(false);
+  auto start = steady_clock::now();
+  std::atomic<long> elapsed(0);
+
+  wheel.schedule(milliseconds(20), [&]() {
+    elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    fired = true;
+  });
+  ASSERT_EQ(wheel.pending(), 1u);
+
+  std::this_thread::sleep_for(milliseconds(200));
+  ASSERT_TRUE(fired);
+  ASSERT_GE(elapsed, 20);
+  ASSERT_EQ(wheel.pending(), 0u);
+  ASSERT_EQ(wheel.stats().fired, 1u);
+}
+
+TEST(TimerWheel, cancel_before_fire) {
+  timer::TimerWheel wheel(milliseconds(1));
+  std::atomic<bool> fired(false);
+
+  auto id = wheel.schedule(milliseconds(50), [&]() { fired = true; });
+  ASSERT_TRUE(wheel.cancel(id));
+  ASSERT_FALSE(wheel.cancel(id));
+
+  std::this_thread::sleep_for(milliseconds(100));
+  ASSERT_FALSE(fired);
+  ASSERT_EQ(wheel.pending(), 0u);
+  ASSERT_EQ(wheel.stats().cancelled, 1u);
+}
+
+TEST(TimerWheel, fires_in_expiry_order_across_levels) {
+  // 1ms ticks put 100ms on the second level, so it has to cascade down
+  timer::TimerWheel wheel(milliseconds(1));
+  std::mutex mutex;
+  std::vector<int> order;
+
+  wheel.schedule(milliseconds(100), [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(100);
+  });
+  wheel.schedule(milliseconds(10), [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(10);
+  });
+  wheel.schedule(milliseconds(70), [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(70);
+  });
+  ASSERT_EQ(wheel.pending(), 3u);
+
+  std::this_thread::sleep_for(milliseconds(300));
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(order, std::vector<int>({10, 70, 100}));
+  ASSERT_EQ(wheel.pending(), 0u);
+}
+
+TEST(TimerWheel, action_may_reschedule) {
+  timer::TimerWheel wheel(milliseconds(1));
+  std::atomic<int> count(0);
+  std::function<void()> again = [&]() {
+    if (++count < 3) {
+      wheel.schedule(milliseconds(5), again);
+    }
+  };
+  wheel.schedule(milliseconds(5), again);
+
+  std::this_thread::sleep_for(milliseconds(200));
+  ASSERT_EQ(count, 3);
+  ASSERT_EQ(wheel.stats().scheduled, 3u);
+}
@@ -0,0 +1,126 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+#include <string>
+#include <validation/admission.hpp>
+
+using Api::Transaction;
+using admission::Strictness;
+using admission::Verdict;
+using admission::View;
+
+namespace {
+
+Api::Asset currency(long long balance) {
+    Api::Asset asset;
+    asset.set_name("iroha");
+    (*asset.mutable_value())["value"].set_valueint(balance);
+    return asset;
+}
+
+Transaction transfer(long long amount) {
+    Transaction tx;
+    tx.set_type("Transfer");
+    tx.set_senderpubkey("alice");
+    tx.set_receivepubkey("bob");
+    *tx.mutable_asset() = currency(amount);
+    return tx;
+}
+
+struct World {
+    std::set<std::string> accounts;
+    std::map<std::string, Api::Asset> assets;
+    int reads = 0;
+
+    View::Source source() {
+        return View::Source{
+            [this](const std::string& publicKey) {
+                reads++;
+                return accounts.count(publicKey) > 0;
+            },
+            [this](const std::string& publicKey, const std::string&) {
+                reads++;
+                auto it = assets.find(publicKey);
+                return it == assets.end() ? Api::Asset() : it->second;
+            }};
+    }
+};
+
+}
+
+TEST(admission, off_admits_everything) {
+    World world;
+    View view(world.source(), std::chrono::minutes(1), 1024);
+    ASSERT_EQ(admission::check(transfer(10), view, Strictness::OFF), Verdict::ADMIT);
+    ASSERT_EQ(world.reads, 0);
+}
+
+TEST(admission, lenient_rejects_only_known_short_balances) {
+    World world;
+    world.accounts = {"alice", "bob"};
+    world.assets["alice"] = currency(5);
+    View view(world.source(), std::chrono::minutes(1), 1024);
+    ASSERT_EQ(admission::check(transfer(5), view, Strictness::LENIENT), Verdict::ADMIT);
+    ASSERT_EQ(admission::check(transfer(6), view, Strictness::LENIENT),
+              Verdict::INSUFFICIENT_BALANCE);
+
+    // bob holds nothing, but lenient leaves that to the executor
+    auto reverse = transfer(1);
+    reverse.set_senderpubkey("bob");
+    reverse.set_receivepubkey("carol");
+    ASSERT_EQ(admission::check(reverse, view, Strictness::LENIENT), Verdict::ADMIT);
+}
+
+TEST(admission, strict_rejects_unknown_accounts_and_assets) {
+    World world;
+    world.accounts = {"alice"};
+    world.assets["alice"] = currency(5);
+    View view(world.source(), std::chrono::minutes(1), 1024);
+    ASSERT_EQ(admission::check(transfer(1), view, Strictness::STRICT),
+              Verdict::UNKNOWN_RECEIVER);
+
+    world.accounts.insert("bob");
+    view.clear();
+    ASSERT_EQ(admission::check(transfer(1), view, Strictness::STRICT), Verdict::NO_ASSET);
+
+    world.assets["bob"] = currency(0);
+    view.clear();
+    ASSERT_EQ(admission::check(transfer(1), view, Strictness::STRICT), Verdict::ADMIT);
+}
+
+TEST(admission, commits_invalidate_the_cache) {
+    World world;
+    world.accounts = {"alice", "bob"};
+    world.assets["alice"] = currency(5);
+    View view(world.source(), std::chrono::minutes(1), 1024);
+    ASSERT_EQ(admission::check(transfer(10), view, Strictness::LENIENT),
+              Verdict::INSUFFICIENT_BALANCE);
+    const auto reads = world.reads;
+    ASSERT_EQ(admission::check(transfer(10), view, Strictness::LENIENT),
+              Verdict::INSUFFICIENT_BALANCE);
+    ASSERT_EQ(world.reads, reads);
+
+    world.assets["alice"] = currency(20);
+    auto deposit = transfer(15);
+    deposit.set_senderpubkey("bob");
+    deposit.set_receivepubkey("alice");
+    view.forget(deposit);
+    ASSERT_EQ(admission::check(transfer(10), view, Strictness::LENIENT), Verdict::ADMIT);
+    ASSERT_EQ(view.stats().hits, 1u);
+}
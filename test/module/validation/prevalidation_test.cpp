@@ -0,0 +1,101 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <string>
+#include <consensus/consensus_envelope.hpp>
+#include <crypto/base64.hpp>
+#include <crypto/signature.hpp>
+#include <validation/prevalidation.hpp>
+
+using Api::Transaction;
+using prevalidation::Verdict;
+using sumeragi::hashTransaction;
+
+namespace {
+
+Transaction wellFormed() {
+    Transaction tx;
+    tx.set_type("add");
+    tx.set_senderpubkey("sender");
+    return tx;
+}
+
+void sign(Transaction& tx) {
+    auto keyPair = signature::generateKeyPair();
+    auto digest = hashTransaction(tx);
+    auto sig = tx.add_txsignatures();
+    sig->set_publickey(base64::encode(keyPair.publicKey));
+    sig->set_signature(signature::sign(digest, keyPair));
+}
+
+}
+
+TEST(prevalidation, accepts_well_formed_transactions) {
+    auto tx = wellFormed();
+    // signatures are optional unless prevalidation_require_signature is set
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::VALID);
+    sign(tx);
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::VALID);
+    ASSERT_EQ(prevalidation::submit(tx, hashTransaction(tx)).get(), Verdict::VALID);
+}
+
+TEST(prevalidation, ignores_the_hash_the_client_sent) {
+    auto tx = wellFormed();
+    sign(tx);
+    // nothing fills the field in, and what a client puts there is not
+    // what gets verified
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::VALID);
+    tx.set_hash("46ed8c250356759f68930a94996faaa8f8c98ecbe0dcc58c479c8fad71e30096");
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::VALID);
+}
+
+TEST(prevalidation, rejects_malformed_transactions) {
+    auto tx = wellFormed();
+    tx.clear_senderpubkey();
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::MALFORMED);
+
+    tx = wellFormed();
+    tx.set_receivepubkey(std::string(1 << 20, 'x'));
+    ASSERT_EQ(prevalidation::check(tx, hashTransaction(tx)), Verdict::TOO_LARGE);
+}
+
+TEST(prevalidation, rejects_bad_signatures) {
+    auto tx = wellFormed();
+    sign(tx);
+    // the body changed after it was signed
+    tx.set_receivepubkey("mallory");
+    ASSERT_EQ(prevalidation::submit(tx, hashTransaction(tx)).get(), Verdict::BAD_SIGNATURE);
+}
+
+TEST(prevalidation, reports_verdicts_and_latency) {
+    auto before = prevalidation::stats();
+    auto tx = wellFormed();
+    prevalidation::check(tx, hashTransaction(tx));
+    tx.clear_type();
+    prevalidation::check(tx, hashTransaction(tx));
+    auto after = prevalidation::stats();
+
+    ASSERT_EQ(after.verdicts[static_cast<int>(Verdict::VALID)],
+              before.verdicts[static_cast<int>(Verdict::VALID)] + 1);
+    ASSERT_EQ(after.verdicts[static_cast<int>(Verdict::MALFORMED)],
+              before.verdicts[static_cast<int>(Verdict::MALFORMED)] + 1);
+    ASSERT_EQ(after.latency.size(), prevalidation::LATENCY_BOUNDS_MICROS.size() + 1);
+    ASSERT_EQ(std::accumulate(after.latency.begin(), after.latency.end(), 0ull),
+              std::accumulate(before.latency.begin(), before.latency.end(), 0ull) + 2);
+}
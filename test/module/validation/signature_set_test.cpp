@@ -0,0 +1,118 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <crypto/base64.hpp>
+#include <crypto/signature.hpp>
+#include <validation/signature_set.hpp>
+#include <validation/signature_verifier.hpp>
+
+using Api::SignatureSet;
+
+namespace {
+std::string fakeSignature(char c) { return std::string(64, c); }
+}
+
+TEST(signature_set, add_keeps_signer_order) {
+    SignatureSet set;
+    ASSERT_TRUE(signature_set::add(set, 9, fakeSignature('9')));
+    ASSERT_TRUE(signature_set::add(set, 0, fakeSignature('0')));
+    ASSERT_TRUE(signature_set::add(set, 3, fakeSignature('3')));
+    ASSERT_FALSE(signature_set::add(set, 3, fakeSignature('x')));
+
+    ASSERT_EQ(signature_set::count(set), 3u);
+    ASSERT_EQ(signature_set::signers(set), std::vector<std::uint32_t>({0, 3, 9}));
+    ASSERT_EQ(set.signatures(0), fakeSignature('0'));
+    ASSERT_EQ(set.signatures(1), fakeSignature('3'));
+    ASSERT_EQ(set.signatures(2), fakeSignature('9'));
+    ASSERT_EQ(set.bitmap().size(), 2u);
+
+    ASSERT_TRUE(signature_set::contains(set, 9));
+    ASSERT_FALSE(signature_set::contains(set, 8));
+    ASSERT_FALSE(signature_set::contains(set, 100));
+}
+
+TEST(signature_set, merge_adds_missing_signers_only) {
+    SignatureSet a, b;
+    a.set_peersetversion(7);
+    b.set_peersetversion(7);
+    signature_set::add(a, 1, fakeSignature('1'));
+    signature_set::add(a, 4, fakeSignature('4'));
+    signature_set::add(b, 4, fakeSignature('x'));
+    signature_set::add(b, 2, fakeSignature('2'));
+
+    ASSERT_EQ(signature_set::merge(a, b), 1u);
+    ASSERT_EQ(signature_set::signers(a), std::vector<std::uint32_t>({1, 2, 4}));
+    ASSERT_EQ(a.signatures(2), fakeSignature('4'));
+    ASSERT_EQ(signature_set::merge(a, b), 0u);
+
+    SignatureSet empty;
+    ASSERT_EQ(signature_set::merge(empty, a), 3u);
+    ASSERT_EQ(empty.peersetversion(), 7u);
+
+    SignatureSet other;
+    other.set_peersetversion(8);
+    signature_set::add(other, 0, fakeSignature('0'));
+    ASSERT_EQ(signature_set::merge(a, other), 0u);
+    ASSERT_EQ(signature_set::count(a), 3u);
+}
+
+TEST(signature_set, well_formed_rejects_what_a_peer_could_forge) {
+    SignatureSet set;
+    signature_set::add(set, 0, fakeSignature('0'));
+    signature_set::add(set, 4, fakeSignature('4'));
+    ASSERT_TRUE(signature_set::wellFormed(set, 5));
+    // a signer past the peer list
+    ASSERT_FALSE(signature_set::wellFormed(set, 4));
+
+    // more bits than signatures
+    SignatureSet short_ = set;
+    short_.mutable_signatures()->RemoveLast();
+    ASSERT_FALSE(signature_set::wellFormed(short_, 5));
+    ASSERT_EQ(signature_set::merge(short_, set), 0u);
+
+    // a signature of the wrong size
+    SignatureSet truncated = set;
+    truncated.set_signatures(1, "short");
+    ASSERT_FALSE(signature_set::wellFormed(truncated, 5));
+
+    // a bitmap far longer than the peer list
+    SignatureSet wide = set;
+    wide.mutable_bitmap()->resize(1 << 20, '\0');
+    ASSERT_FALSE(signature_set::wellFormed(wide, 5));
+}
+
+TEST(signature_set, verify_raw_signatures_by_signer) {
+    const std::string message = "digest";
+    std::vector<std::string> publicKeys;
+    SignatureSet set;
+    for (std::uint32_t i = 0; i < 5; i++) {
+        auto keyPair = signature::generateKeyPair();
+        publicKeys.push_back(base64::encode(keyPair.publicKey));
+        auto raw = signature::sign(message, keyPair.publicKey, keyPair.privateKey);
+        signature_set::add(set, i, std::string(raw.begin(), raw.end()));
+    }
+    // a signature of signer 1 claimed by signer 6, who has no key
+    signature_set::add(set, 6, set.signatures(1));
+
+    auto valid = signature_verifier::verify(set, message, publicKeys);
+    ASSERT_EQ(valid, std::vector<bool>({true, true, true, true, true, false}));
+    ASSERT_TRUE(signature_verifier::verifyRaw(set.signatures(2), message, publicKeys[2]));
+    ASSERT_FALSE(signature_verifier::verifyRaw(set.signatures(2), message, publicKeys[3]));
+}
@@ -18,7 +18,9 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <crypto/signature.hpp>
+#include <validation/signature_verifier.hpp>
 #include <validation/transaction_validator.hpp>
+#include <crypto/base64.hpp>
 #include <infra/protobuf/api.grpc.pb.h>
 
 using Api::ConsensusEvent;
@@ -63,3 +65,28 @@ TEST(transaction_validator, verify_consensus_event) {
     ASSERT_NE(transaction_validator::signaturesAreValid(ev),
         signature::verify(signature_b64, hash, public_key_b64));
 }
+
+TEST(signature_verifier, bitmap) {
+    const std::string digest = "digest of some round";
+    ConsensusEvent ev;
+    for (int i = 0; i < 8; i++) {
+        auto keyPair = signature::generateKeyPair();
+        auto sig = ev.add_eventsignatures();
+        sig->set_publickey(base64::encode(keyPair.publicKey));
+        // every third signature is over something else
+        sig->set_signature(signature::sign(i % 3 == 0 ? "other" : digest, keyPair));
+    }
+    // a repeated signature is verified again
+    ev.add_eventsignatures()->CopyFrom(ev.eventsignatures(1));
+
+    auto bitmap = signature_verifier::verify(ev.eventsignatures(), digest);
+    ASSERT_EQ(bitmap.size(), 9u);
+    for (int i = 0; i < 8; i++) {
+        ASSERT_EQ(bitmap[i], i % 3 != 0) << i;
+    }
+    ASSERT_TRUE(bitmap[8]);
+
+    // only the tail is verified when asked to
+    auto tail = signature_verifier::verify(ev.eventsignatures(), digest, 6);
+    ASSERT_EQ(tail, std::vector<bool>({false, true, true}));
+}